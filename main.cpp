@@ -1,10 +1,11 @@
 #include <iostream>
 #include "modules/Json.hpp"
+#include "modules/JsonStream.hpp"
 
 int main() {
     std::string fileName;
     std::cout << "Enter the file name: ";
     std::cin >> fileName;
     Json::Json json = Json::parseJsonFromFile(fileName);
-    std::cout << json.deserialize();
+    Json::serialize(json, std::cout);
 }
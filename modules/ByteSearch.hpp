@@ -0,0 +1,44 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JSON_SSE2
+
+#include <emmintrin.h>
+#endif
+
+namespace Json {
+    // '[' and ']' become '{' and '}' once this bit is set, so two compares find all four brackets.
+    constexpr char bracketFold = 0x20;
+
+#ifdef JSON_SSE2
+    // All ones in the lanes of bytes that equal c.
+    inline __m128i bytesEqual(const __m128i bytes, const char c) {
+        return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+    }
+#endif
+
+    // Position of the first byte of text at or after from that is in ByteSet, text.size() when there is none.
+    // ByteSet is called with a char to test one byte and, with SSE2, with 16 bytes to get all ones in the lanes
+    // of the bytes it holds. Whole 16 byte blocks are tested at once, the rest one byte at a time.
+    template<class ByteSet>
+    size_t findFirst(const std::string_view text, size_t from, const ByteSet set) {
+#ifdef JSON_SSE2
+        for (; from + 16 <= text.size(); from += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + from));
+            if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(set(bytes)))) {
+                return from + std::countr_zero(mask);
+            }
+        }
+#endif
+        for (; from < text.size(); from++) {
+            if (set(text[from])) {
+                return from;
+            }
+        }
+        return text.size();
+    }
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <new>
+#include <string>
+#include "CompactJson.hpp"
+#include "Json.hpp"
+#include "JsonBuilder.hpp"
+#include "JsonSax.hpp"
+#include "JsonWriter.hpp"
+
+namespace Json {
+    CompactJson::LongString *CompactJson::allocateString(const StringView text) {
+        auto *string = static_cast<LongString *>(::operator new(sizeof(LongString) + text.size()));
+        string->length = text.size();
+        std::memcpy(string->text(), text.data(), text.size());
+        return string;
+    }
+
+    CompactJson::CompactJson(const StringView text) {
+        if (text.size() <= shortLimit) {
+            tag = Tag::SHORT_STRING;
+            std::copy_n(text.data(), text.size(), storage);
+            storage[shortLimit] = static_cast<unsigned char>(text.size());
+            return;
+        }
+        store(allocateString(text));
+        tag = Tag::LONG_STRING;
+    }
+
+    CompactJson::CompactJson(CompactArray &&array) : tag(Tag::ARRAY) {
+        store(new CompactArray(std::move(array)));
+    }
+
+    CompactJson::CompactJson(CompactObject &&object) : tag(Tag::OBJECT) {
+        store(new CompactObject(std::move(object)));
+    }
+
+    void CompactJson::release() {
+        switch (tag) {
+            case Tag::LONG_STRING:
+                ::operator delete(load<LongString *>());
+                break;
+            case Tag::ARRAY:
+                delete load<CompactArray *>();
+                break;
+            case Tag::OBJECT:
+                delete load<CompactObject *>();
+                break;
+            default:
+                break;
+        }
+        tag = Tag::NULLPTR;
+    }
+
+    void CompactJson::copyFrom(const CompactJson &other) {
+        switch (other.tag) {
+            case Tag::LONG_STRING:
+                store(allocateString(other.getStringView()));
+                tag = Tag::LONG_STRING;
+                break;
+            case Tag::ARRAY:
+                store(new CompactArray(*other.load<CompactArray *>()));
+                tag = Tag::ARRAY;
+                break;
+            case Tag::OBJECT:
+                store(new CompactObject(*other.load<CompactObject *>()));
+                tag = Tag::OBJECT;
+                break;
+            default:
+                std::memcpy(storage, other.storage, sizeof storage);
+                tag = other.tag;
+                break;
+        }
+    }
+
+    std::string CompactJson::deserialize(const Format format) const {
+        Writer writer(format);
+        writer.write(*this);
+        return std::move(writer.output());
+    }
+
+    CompactJson parseJsonCompact(const StringView str) {
+        NodeBuilder<CompactJson, CompactObject, CompactArray> builder;
+        parseJsonSax(str, builder);
+        return std::move(builder.root);
+    }
+
+    CompactJson toCompact(const Json &json) {
+        switch (json.what()) {
+            case DataType::STRING:
+                return CompactJson{json.getStringView()};
+            case DataType::OBJECT: {
+                CompactObject object;
+                object.reserve(json.get<Object>().size());
+                for (auto &&[K, V]: json.get<Object>()) {
+                    object.insert_or_assign(Key(K.view()), toCompact(V));
+                }
+                return CompactJson{std::move(object)};
+            }
+            case DataType::ARRAY: {
+                CompactArray array;
+                array.reserve(json.get<Array>().size());
+                for (const Json &element: json.get<Array>()) {
+                    array.push_back(toCompact(element));
+                }
+                return CompactJson{std::move(array)};
+            }
+            case DataType::NUMBER:
+                return CompactJson{json.get<Number>()};
+            case DataType::INTEGER:
+                return CompactJson{json.get<Integer>()};
+            case DataType::UNSIGNED:
+                return CompactJson{json.get<Unsigned>()};
+            case DataType::BOOL:
+                return CompactJson{json.get<Bool>()};
+            default:
+                return CompactJson{};
+        }
+    }
+}
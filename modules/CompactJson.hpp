@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "JsonForwardHeader.hpp"
+
+namespace Json {
+    class CompactJson;
+
+    using CompactArray = std::vector<CompactJson>;
+    using CompactObject = FlatMap<Key, CompactJson>;
+
+    // Json node packed into 16 bytes, for documents that are mostly scalars. Scalars and strings of up to
+    // shortLimit bytes are stored inline, longer strings and containers live behind an owned pointer.
+    // Same get<T> / visit / what() surface as Json, except that strings always come back as StringView and
+    // scalars by value.
+    class CompactJson {
+    private:
+        enum class Tag : uint8_t {
+            NULLPTR,
+            BOOL,
+            NUMBER,
+            INTEGER,
+            UNSIGNED,
+            SHORT_STRING,
+            LONG_STRING,
+            ARRAY,
+            OBJECT
+        };
+
+        // Out-of-line string, the text follows the header in the same allocation.
+        struct LongString {
+            size_t length;
+
+            char *text() {
+                return reinterpret_cast<char *>(this + 1);
+            }
+        };
+
+        constexpr static size_t shortLimit = 14;
+
+        // Scalars and pointers take the first 8 bytes. Short strings take the first 14 and keep their
+        // length in byte 14.
+        alignas(8) unsigned char storage[15]{};
+        Tag tag = Tag::NULLPTR;
+
+        template<class T>
+        [[nodiscard]] T load() const {
+            T value;
+            std::memcpy(&value, storage, sizeof value);
+            return value;
+        }
+
+        template<class T>
+        void store(const T value) {
+            std::memcpy(storage, &value, sizeof value);
+        }
+
+        void expect(const bool matches) const {
+            if (!matches) throw std::bad_variant_access();
+        }
+
+        static LongString *allocateString(StringView text);
+
+        void release();
+
+        void copyFrom(const CompactJson &other);
+
+    public:
+        CompactJson() = default;
+
+        explicit CompactJson(StringView text);
+
+        explicit CompactJson(const char *text) : CompactJson(StringView(text)) {}
+
+        explicit CompactJson(CompactArray &&array);
+
+        explicit CompactJson(CompactObject &&object);
+
+        explicit CompactJson(const Number number) : tag(Tag::NUMBER) {
+            store(number);
+        }
+
+        explicit CompactJson(const Integer number) : tag(Tag::INTEGER) {
+            store(number);
+        }
+
+        explicit CompactJson(const Unsigned number) : tag(Tag::UNSIGNED) {
+            store(number);
+        }
+
+        explicit CompactJson(const Bool value) : tag(Tag::BOOL) {
+            store(value);
+        }
+
+        CompactJson(const CompactJson &other) {
+            copyFrom(other);
+        }
+
+        CompactJson(CompactJson &&other) noexcept : tag(other.tag) {
+            std::memcpy(storage, other.storage, sizeof storage);
+            other.tag = Tag::NULLPTR;
+        }
+
+        CompactJson &operator=(const CompactJson &other) {
+            if (this != &other) {
+                CompactJson copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        CompactJson &operator=(CompactJson &&other) noexcept {
+            if (this != &other) {
+                release();
+                std::memcpy(storage, other.storage, sizeof storage);
+                tag = other.tag;
+                other.tag = Tag::NULLPTR;
+            }
+            return *this;
+        }
+
+        ~CompactJson() {
+            release();
+        }
+
+        [[nodiscard]] DataType what() const {
+            switch (tag) {
+                case Tag::SHORT_STRING:
+                case Tag::LONG_STRING:
+                    return DataType::STRING;
+                case Tag::OBJECT:
+                    return DataType::OBJECT;
+                case Tag::ARRAY:
+                    return DataType::ARRAY;
+                case Tag::NUMBER:
+                    return DataType::NUMBER;
+                case Tag::INTEGER:
+                    return DataType::INTEGER;
+                case Tag::UNSIGNED:
+                    return DataType::UNSIGNED;
+                case Tag::BOOL:
+                    return DataType::BOOL;
+                default:
+                    return DataType::NULLPTR;
+            }
+        }
+
+        [[nodiscard]] StringView getStringView() const {
+            if (tag == Tag::SHORT_STRING) {
+                return {reinterpret_cast<const char *>(storage), storage[shortLimit]};
+            }
+            expect(tag == Tag::LONG_STRING);
+            LongString *string = load<LongString *>();
+            return {string->text(), string->length};
+        }
+
+        // Reads any of the numeric alternatives as a double.
+        [[nodiscard]] Number getNumber() const {
+            switch (tag) {
+                case Tag::INTEGER:
+                    return static_cast<Number>(load<Integer>());
+                case Tag::UNSIGNED:
+                    return static_cast<Number>(load<Unsigned>());
+                default:
+                    expect(tag == Tag::NUMBER);
+                    return load<Number>();
+            }
+        }
+
+        // Containers come back as references with the constness of this node. A mismatching type throws
+        // std::bad_variant_access like Json::get does.
+        template<class T>
+        decltype(auto) get(this auto &&self) {
+            constexpr bool isConst = std::is_const_v<std::remove_reference_t<decltype(self)>>;
+            if constexpr (std::is_same_v<T, String> || std::is_same_v<T, StringView>) {
+                return self.getStringView();
+            } else if constexpr (std::is_same_v<T, Object>) {
+                self.expect(self.tag == Tag::OBJECT);
+                using Result = std::conditional_t<isConst, const CompactObject, CompactObject>;
+                return static_cast<Result &>(*self.template load<CompactObject *>());
+            } else if constexpr (std::is_same_v<T, Array>) {
+                self.expect(self.tag == Tag::ARRAY);
+                using Result = std::conditional_t<isConst, const CompactArray, CompactArray>;
+                return static_cast<Result &>(*self.template load<CompactArray *>());
+            } else if constexpr (std::is_same_v<T, Number>) {
+                self.expect(self.tag == Tag::NUMBER);
+                return self.template load<Number>();
+            } else if constexpr (std::is_same_v<T, Integer>) {
+                self.expect(self.tag == Tag::INTEGER);
+                return self.template load<Integer>();
+            } else if constexpr (std::is_same_v<T, Unsigned>) {
+                self.expect(self.tag == Tag::UNSIGNED);
+                return self.template load<Unsigned>();
+            } else if constexpr (std::is_same_v<T, Bool>) {
+                self.expect(self.tag == Tag::BOOL);
+                return self.template load<Bool>();
+            } else {
+                static_assert(std::is_same_v<T, NullPtr>, "CompactJson::get, not a Json alternative");
+                self.expect(self.tag == Tag::NULLPTR);
+                return nullptr;
+            }
+        }
+
+        decltype(auto) visit(this auto &&self, auto &&visitor) {
+            switch (self.what()) {
+                case DataType::STRING:
+                    return visitor(self.getStringView());
+                case DataType::OBJECT:
+                    return visitor(self.template get<Object>());
+                case DataType::ARRAY:
+                    return visitor(self.template get<Array>());
+                case DataType::NUMBER:
+                    return visitor(self.template get<Number>());
+                case DataType::INTEGER:
+                    return visitor(self.template get<Integer>());
+                case DataType::UNSIGNED:
+                    return visitor(self.template get<Unsigned>());
+                case DataType::BOOL:
+                    return visitor(self.template get<Bool>());
+                default:
+                    return visitor(nullptr);
+            }
+        }
+
+        [[nodiscard]] std::string deserialize(Format format = Format::PRETTY) const;
+    };
+
+    static_assert(sizeof(CompactJson) == 16);
+
+    CompactJson parseJsonCompact(StringView str);
+
+    CompactJson toCompact(const Json &json);
+}
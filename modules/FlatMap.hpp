@@ -0,0 +1,313 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Json {
+    // Map from string keys kept as one contiguous array of entries in insertion order. Small maps are searched
+    // linearly; from linearLimit entries on, a hash index of entry positions is kept next to the array.
+    // Like std::flat_map, iterators refer to an entry by a pair of references, with the key const so that it
+    // cannot be changed behind the index.
+    template<class Key, class Value>
+    class FlatMap {
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+        using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+        using reference = std::pair<const Key &, Value &>;
+        using const_reference = std::pair<const Key &, const Value &>;
+
+        template<bool IsConst>
+        class Iterator {
+        private:
+            using Base = std::conditional_t<IsConst, typename std::pmr::vector<std::pair<Key, Value>>::const_iterator,
+                    typename std::pmr::vector<std::pair<Key, Value>>::iterator>;
+
+            Base it;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::pair<Key, Value>;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::pair<const Key &, std::conditional_t<IsConst, const Value &, Value &>>;
+
+            // What operator-> points to, the pair of references lives as long as this does.
+            struct pointer {
+                reference entry;
+
+                const reference *operator->() const {
+                    return &entry;
+                }
+            };
+
+            Iterator() = default;
+
+            explicit Iterator(const Base it) : it(it) {}
+
+            template<bool OtherConst> requires (IsConst && !OtherConst)
+            Iterator(const Iterator<OtherConst> &other) : it(other.base()) {}
+
+            [[nodiscard]] Base base() const {
+                return it;
+            }
+
+            reference operator*() const {
+                return {it->first, it->second};
+            }
+
+            pointer operator->() const {
+                return {**this};
+            }
+
+            reference operator[](const difference_type n) const {
+                return *(*this + n);
+            }
+
+            Iterator &operator++() {
+                ++it;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                return Iterator(it++);
+            }
+
+            Iterator &operator--() {
+                --it;
+                return *this;
+            }
+
+            Iterator operator--(int) {
+                return Iterator(it--);
+            }
+
+            Iterator &operator+=(const difference_type n) {
+                it += n;
+                return *this;
+            }
+
+            Iterator &operator-=(const difference_type n) {
+                it -= n;
+                return *this;
+            }
+
+            friend Iterator operator+(const Iterator &iterator, const difference_type n) {
+                return Iterator(iterator.it + n);
+            }
+
+            friend Iterator operator+(const difference_type n, const Iterator &iterator) {
+                return Iterator(iterator.it + n);
+            }
+
+            friend Iterator operator-(const Iterator &iterator, const difference_type n) {
+                return Iterator(iterator.it - n);
+            }
+
+            friend difference_type operator-(const Iterator &a, const Iterator &b) {
+                return a.it - b.it;
+            }
+
+            friend bool operator==(const Iterator &a, const Iterator &b) = default;
+
+            friend auto operator<=>(const Iterator &a, const Iterator &b) = default;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        constexpr static size_t linearLimit = 16;
+
+    private:
+        std::pmr::vector<value_type> entries;
+
+        // Open addressing table holding entry positions plus one, 0 marks a free slot. At most half full,
+        // empty while the map is below linearLimit.
+        std::pmr::vector<uint32_t> slots;
+
+        template<class Text>
+        static size_t hash(const Text &key) {
+            // Keys that know their hash, as pooled ones do, are not hashed again.
+            if constexpr (requires { { key.hash() } -> std::convertible_to<size_t>; }) {
+                return key.hash();
+            } else {
+                return std::hash<std::string_view>{}(key);
+            }
+        }
+
+        // Position of key in entries, entries.size() when it is missing. Lookups by Key compare whole keys,
+        // everything else is compared as text.
+        template<class Lookup>
+        [[nodiscard]] size_t position(const Lookup &lookup) const {
+            using Compared = std::conditional_t<std::is_same_v<Lookup, Key>, const Key &, std::string_view>;
+            const Compared key = lookup;
+            if (slots.empty()) {
+                for (size_t i = 0; i < entries.size(); i++) {
+                    if (entries[i].first == key) return i;
+                }
+                return entries.size();
+            }
+            const size_t mask = slots.size() - 1;
+            for (size_t slot = hash(key) & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+                if (entries[slots[slot] - 1].first == key) return slots[slot] - 1;
+            }
+            return entries.size();
+        }
+
+        void indexEntry(const size_t i) {
+            const size_t mask = slots.size() - 1;
+            size_t slot = hash(entries[i].first) & mask;
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = static_cast<uint32_t>(i + 1);
+        }
+
+        void rebuildIndex() {
+            slots.clear();
+            if (entries.size() < linearLimit) return;
+            slots.assign(std::bit_ceil(entries.size() * 2), 0);
+            for (size_t i = 0; i < entries.size(); i++) {
+                indexEntry(i);
+            }
+        }
+
+        // Keeps the index up to date after an entry was appended.
+        void indexLast() {
+            if (entries.size() < linearLimit) return;
+            if (entries.size() * 2 > slots.size()) {
+                rebuildIndex();
+            } else {
+                indexEntry(entries.size() - 1);
+            }
+        }
+
+    public:
+        FlatMap() = default;
+
+        explicit FlatMap(const allocator_type &allocator) : entries(allocator), slots(allocator) {}
+
+        [[nodiscard]] allocator_type get_allocator() const {
+            return entries.get_allocator();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return entries.size();
+        }
+
+        [[nodiscard]] bool empty() const {
+            return entries.empty();
+        }
+
+        void reserve(const size_t count) {
+            entries.reserve(count);
+        }
+
+        void clear() {
+            entries.clear();
+            slots.clear();
+        }
+
+        iterator begin() {
+            return iterator(entries.begin());
+        }
+
+        iterator end() {
+            return iterator(entries.end());
+        }
+
+        [[nodiscard]] const_iterator begin() const {
+            return const_iterator(entries.begin());
+        }
+
+        [[nodiscard]] const_iterator end() const {
+            return const_iterator(entries.end());
+        }
+
+        iterator find(const std::string_view key) {
+            return begin() + static_cast<std::ptrdiff_t>(position(key));
+        }
+
+        [[nodiscard]] const_iterator find(const std::string_view key) const {
+            return begin() + static_cast<std::ptrdiff_t>(position(key));
+        }
+
+        [[nodiscard]] bool contains(const std::string_view key) const {
+            return position(key) != entries.size();
+        }
+
+        Value &at(const std::string_view key) {
+            const size_t i = position(key);
+            if (i == entries.size()) throw std::out_of_range("FlatMap::at, no such key");
+            return entries[i].second;
+        }
+
+        [[nodiscard]] const Value &at(const std::string_view key) const {
+            const size_t i = position(key);
+            if (i == entries.size()) throw std::out_of_range("FlatMap::at, no such key");
+            return entries[i].second;
+        }
+
+        // Appends the key with a default value when it is missing.
+        Value &operator[](const std::string_view key) {
+            return try_emplace(key).first->second;
+        }
+
+        template<class K, class... Args>
+        std::pair<iterator, bool> try_emplace(K &&key, Args &&... args) {
+            const size_t i = position(key);
+            if (i != entries.size()) {
+                return {begin() + static_cast<std::ptrdiff_t>(i), false};
+            }
+            entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+            indexLast();
+            return {end() - 1, true};
+        }
+
+        // A key that is already there keeps its place and takes the new value.
+        template<class K, class V>
+        std::pair<iterator, bool> insert_or_assign(K &&key, V &&value) {
+            const size_t i = position(key);
+            if (i != entries.size()) {
+                entries[i].second = std::forward<V>(value);
+                return {begin() + static_cast<std::ptrdiff_t>(i), false};
+            }
+            entries.emplace_back(std::forward<K>(key), std::forward<V>(value));
+            indexLast();
+            return {end() - 1, true};
+        }
+
+        // Puts a key that is not in the map yet before pos. Later entries move up one place.
+        template<class K, class V>
+        iterator insert(const const_iterator pos, K &&key, V &&value) {
+            const auto it = entries.emplace(pos.base(), std::forward<K>(key), std::forward<V>(value));
+            rebuildIndex();
+            return iterator(it);
+        }
+
+        // Later entries move up one place to keep the order, so this is linear in the size of the map.
+        iterator erase(const const_iterator it) {
+            const auto next = entries.erase(it.base());
+            rebuildIndex();
+            return iterator(next);
+        }
+
+        size_t erase(const std::string_view key) {
+            const size_t i = position(key);
+            if (i == entries.size()) return 0;
+            erase(begin() + static_cast<std::ptrdiff_t>(i));
+            return 1;
+        }
+    };
+}
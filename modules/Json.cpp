@@ -2,146 +2,288 @@
 // Created by Yiran on 2024-07-13.
 //
 
-#include <sstream>
-#include "Json.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include "ByteSearch.hpp"
+#include "JsonStream.hpp"
+#include "JsonWriter.hpp"
 
 namespace Json {
-    struct SmartPrinter {
-        size_t indent = 0;
-        constexpr static size_t indentSize = 2;
+    namespace {
+        constexpr size_t indentSize = 2;
 
-        std::stringstream ss;
+        // Indentation is copied out of this in slices instead of being written one space at a time.
+        constexpr StringView indentSpaces = "                                                                ";
 
-        SmartPrinter &nextLine() {
-            ss << '\n';
-            make_indent();
-            return *this;
+        // Quotes, backslashes and control characters, everything RFC 8259 requires to be escaped.
+        struct NeedsEscape {
+            bool operator()(const char c) const {
+                return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+            }
+
+#ifdef JSON_SSE2
+            __m128i operator()(const __m128i bytes) const {
+                const __m128i lastControl = _mm_set1_epi8(0x1F);
+                // Unsigned bytes <= 0x1F are the ones max() leaves at 0x1F.
+                const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(bytes, lastControl), lastControl);
+                return _mm_or_si128(_mm_or_si128(bytesEqual(bytes, '"'), bytesEqual(bytes, '\\')), control);
+            }
+#endif
+        };
+    }
+
+    template<class Output>
+    void BasicWriter<Output>::nextLine() {
+        out.push_back('\n');
+        for (size_t spaces = indent * indentSize; spaces > 0;) {
+            const size_t length = std::min(spaces, indentSpaces.size());
+            append(indentSpaces.substr(0, length));
+            spaces -= length;
         }
+    }
 
-        SmartPrinter &commaNextLine() {
-            ss << ",\n";
-            make_indent();
-            return *this;
+    template<class Output>
+    void BasicWriter<Output>::openContainer(const char open) {
+        out.push_back(open);
+        indent++;
+        if (format == Format::PRETTY) nextLine();
+    }
+
+    template<class Output>
+    void BasicWriter<Output>::closeContainer(const char close) {
+        indent--;
+        if (format == Format::PRETTY) nextLine();
+        out.push_back(close);
+    }
+
+    template<class Output>
+    void BasicWriter<Output>::separator() {
+        out.push_back(',');
+        if (format == Format::PRETTY) nextLine();
+    }
+
+    template<class Output>
+    void BasicWriter<Output>::colon() {
+        if (format == Format::PRETTY) {
+            append(": ");
+        } else {
+            out.push_back(':');
         }
+    }
 
-        SmartPrinter &colonSpace() {
-            ss << ": ";
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::writeObject(const auto &object) {
+        if (object.empty()) {
+            append("{}");
             return *this;
         }
 
-        SmartPrinter &make_indent() {
-            for (size_t i = 0; i < indent; i++) {
-                for (size_t j = 0; j < indentSize; j++) {
-                    ss << ' ';
-                }
+        openContainer('{');
+        bool first = true;
+        const auto member = [&](const Key &key, const auto &value) {
+            if (!first) separator();
+            first = false;
+            writeEscaped(key);
+            colon();
+            write(value);
+        };
+        // Most objects already have their keys in order, those are written without sorting.
+        const auto byKey = [](const auto &a, const auto &b) { return a.first.view() < b.first.view(); };
+        if (order == MemberOrder::SORTED && !std::is_sorted(object.begin(), object.end(), byKey)) {
+            for (const auto &it: members(object)) {
+                member(it->first, it->second);
             }
+        } else {
+            for (auto &&[K, V]: object) {
+                member(K, V);
+            }
+        }
+        closeContainer('}');
+        return *this;
+    }
+
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::writeArray(const auto &array) {
+        if (array.empty()) {
+            append("[]");
             return *this;
         }
 
-        struct IndentPrintGuard {
-            IndentPrintGuard() = delete;
+        openContainer('[');
+        bool first = true;
+        for (auto &&element: array) {
+            if (!first) separator();
+            first = false;
+            write(element);
+        }
+        closeContainer(']');
+        return *this;
+    }
 
-            const char right;
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Object &object) {
+        return writeObject(object);
+    }
 
-            SmartPrinter &printer;
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Array &array) {
+        return writeArray(array);
+    }
 
-            IndentPrintGuard(const char left, const char right, SmartPrinter &printer) : right(right),
-                                                                                         printer(printer) {
-                printer << left;
-                printer.indent++;
-                printer.nextLine();
-            }
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const CompactObject &object) {
+        return writeObject(object);
+    }
 
-            ~IndentPrintGuard() {
-                printer.indent--;
-                printer.nextLine();
-                printer << right;
-            }
-        };
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const CompactArray &array) {
+        return writeArray(array);
+    }
 
-        SmartPrinter &operator<<(const std::string &str) {
-            ss << str;
-            return *this;
-        }
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const SharedObject &object) {
+        return writeObject(object);
+    }
 
-        SmartPrinter &operator<<(const char c) {
-            ss << c;
-            return *this;
-        }
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const SharedArray &array) {
+        return writeArray(array);
+    }
 
-        SmartPrinter &operator<<(const double d) {
-            ss << d;
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Number number) {
+        // Json has no infinities or NaNs.
+        if (!std::isfinite(number)) {
+            append("null");
             return *this;
         }
 
-        SmartPrinter &autoAppend(const Json &json) {
-            return json.visit(*this);
+        // Whole numbers that fit the 53 bit mantissa print as integers, the most common case in real documents.
+        // Negative zero is left to to_chars, as an integer it would lose its sign.
+        constexpr Number exactIntegerLimit = 9007199254740992.0;
+        if (number > -exactIntegerLimit && number < exactIntegerLimit) {
+            const auto integer = static_cast<Integer>(number);
+            if (static_cast<Number>(integer) == number && (integer != 0 || !std::signbit(number))) {
+                return (*this)(integer);
+            }
         }
 
-        SmartPrinter &operator()(const Object &map) {
-            IndentPrintGuard guard{'{', '}', *this};
+        // The shortest digits that read back as the same double.
+        char buffer[32];
+        const auto [end, ec] = std::to_chars(buffer, buffer + sizeof buffer, number);
+        out.append(buffer, end - buffer);
+        return *this;
+    }
 
-            size_t i = 0;
-            const size_t lastIndex = map.size() - 1;
-            for (auto &&[K, V]: map) {
-                (*this << '"' << K << '"').colonSpace().autoAppend(V);
-                if (i++ != lastIndex) this->commaNextLine();
-            }
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Integer number) {
+        char buffer[24];
+        const auto [end, ec] = std::to_chars(buffer, buffer + sizeof buffer, number);
+        out.append(buffer, end - buffer);
+        return *this;
+    }
 
-            return *this;
-        }
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Unsigned number) {
+        char buffer[24];
+        const auto [end, ec] = std::to_chars(buffer, buffer + sizeof buffer, number);
+        out.append(buffer, end - buffer);
+        return *this;
+    }
 
-        SmartPrinter &operator()(const Array &array) {
-            IndentPrintGuard guard{'[', ']', *this};
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const Bool value) {
+        append(value ? "true" : "false");
+        return *this;
+    }
+
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const NullPtr) {
+        append("null");
+        return *this;
+    }
 
-            for (size_t i = 0; i < array.size() - 1; i++) {
-                this->autoAppend(array[i]).commaNextLine();
+    template<class Output>
+    BasicWriter<Output> &BasicWriter<Output>::operator()(const StringView string) {
+        writeEscaped(string);
+        return *this;
+    }
+
+    template<class Output>
+    void BasicWriter<Output>::writeEscaped(const StringView string) {
+        out.push_back('"');
+        size_t clean = 0;
+        while (true) {
+            const size_t special = findFirst(string, clean, NeedsEscape{});
+            append(string.substr(clean, special - clean));
+            if (special == string.size()) {
+                break;
             }
-            this->autoAppend(array.back());
 
-            return *this;
+            const char c = string[special];
+            switch (c) {
+                case '"':
+                    append("\\\"");
+                    break;
+                case '\\':
+                    append("\\\\");
+                    break;
+                case '\b':
+                    append("\\b");
+                    break;
+                case '\f':
+                    append("\\f");
+                    break;
+                case '\n':
+                    append("\\n");
+                    break;
+                case '\r':
+                    append("\\r");
+                    break;
+                case '\t':
+                    append("\\t");
+                    break;
+                default: {
+                    constexpr StringView hexDigits = "0123456789abcdef";
+                    const char escape[] = {'\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF]};
+                    out.append(escape, sizeof escape);
+                    break;
+                }
+            }
+            clean = special + 1;
         }
+        out.push_back('"');
+    }
 
-        SmartPrinter &operator()(const Number number) {
-            return *this << number;
-        }
+    template class BasicWriter<std::string>;
 
-        SmartPrinter &operator()(const Bool val) {
-            this->ss << std::boolalpha << val;
-            return *this;
-        }
+    template class BasicWriter<SizeCounter>;
 
-        SmartPrinter &operator()(const NullPtr) {
-            return *this << "null";
-        }
+    template class BasicWriter<SinkBuffer>;
 
-        SmartPrinter &operator()(const String &string) {
-            static const std::map<char, std::string> escapeMap = {
-                    {'\n', "\\n"},
-                    {'\r', "\\r"},
-                    {'\t', "\\t"},
-                    {'\b', "\\b"},
-                    {'\f', "\\f"},
-                    {'"',  "\\\""}
-            };
-
-            *this << '"';
-            for (char i: string) {
-                if (escapeMap.find(i) != escapeMap.end()) {
-                    *this << escapeMap.at(i);
-                } else {
-                    *this << i;
-                }
-            }
-            return *this << '"';
-        }
+    size_t serializedSize(const Json &json, const Format format) {
+        BasicWriter<SizeCounter> counter(format);
+        counter.write(json);
+        return counter.output().size;
+    }
 
-        [[nodiscard]] std::string build() const {
-            return ss.str();
+    std::string Json::deserialize(const Format format, const bool presize, const MemberOrder order) const {
+        Writer writer(format, order);
+        if (presize) {
+            writer.output().reserve(serializedSize(*this, format));
         }
-    };
+        writer.write(*this);
+        return std::move(writer.output());
+    }
 
-    std::string Json::deserialize() {
-        return this->visit(SmartPrinter{}).build();
+    std::string Document::deserialize(const Format format, const bool verbatim) const {
+        Writer writer(format, verbatim ? MemberOrder::INSERTION : MemberOrder::SORTED);
+        if (verbatim) {
+            writer.copyUnchanged(*this);
+        }
+        writer.write(root);
+        return std::move(writer.output());
     }
-}
\ No newline at end of file
+}
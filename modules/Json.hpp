@@ -1,16 +1,26 @@
 #pragma once
 
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 #include <variant>
 #include "JsonForwardHeader.hpp"
 
 namespace Json {
     class Json {
     private:
-        std::variant<String, Object, Array, Number, Bool, NullPtr> data;
+        std::variant<String, Object, Array, Number, Bool, NullPtr, StringView, Integer, Unsigned> data;
 
     public:
         template<class T>
         decltype(auto) get(this auto &&self) {
+            if constexpr (std::is_same_v<T, String>) {
+                if (std::holds_alternative<StringView>(self.data)) {
+                    throw std::runtime_error("Invalid Json access, the string is a view of the parsed text, "
+                                             "read it with getStringView()");
+                }
+            }
             return std::get<T>(self.data);
         }
 
@@ -18,11 +28,34 @@ namespace Json {
             return std::visit(visitor, self.data);
         }
 
+        // Reads a string value whether it is owned or a view into a Document's text.
+        [[nodiscard]] StringView getStringView() const {
+            if (const auto *view = std::get_if<StringView>(&data)) {
+                return *view;
+            }
+            return std::get<String>(data);
+        }
+
+        // Reads any of the numeric alternatives as a double. Parsed numbers without a fraction or exponent are
+        // Integer, or Unsigned above its range, so get<Number>() throws for "1": read numbers through this
+        // unless the alternative is known.
+        [[nodiscard]] Number getNumber() const {
+            if (const auto *integer = std::get_if<Integer>(&data)) {
+                return static_cast<Number>(*integer);
+            }
+            if (const auto *value = std::get_if<Unsigned>(&data)) {
+                return static_cast<Number>(*value);
+            }
+            return std::get<Number>(data);
+        }
+
 /*        [[nodiscard]] const std::variant<String, Object, Array, Number,
                 Bool, NullPtr> &getData() const {
             return data;
         }*/
 
+        // STRING is either an owned String or, after parseJsonInsitu, a StringView into the parsed text.
+        // get<String>() throws for a view, read strings through getStringView() unless they are known to be owned.
         [[nodiscard]] DataType what() const {
             constexpr struct {
                 DataType operator()(const String &) const { return DataType::STRING; }
@@ -36,6 +69,12 @@ namespace Json {
                 DataType operator()(const Bool &) const { return DataType::BOOL; }
 
                 DataType operator()(const NullPtr &) const { return DataType::NULLPTR; }
+
+                DataType operator()(const StringView &) const { return DataType::STRING; }
+
+                DataType operator()(const Integer &) const { return DataType::INTEGER; }
+
+                DataType operator()(const Unsigned &) const { return DataType::UNSIGNED; }
             } visitor;
 
             return std::visit(visitor, data);
@@ -54,9 +93,13 @@ namespace Json {
 
         // Now declare the constructors, we want copy and move constructors for non-trivial types
 
-        explicit Json(const std::string &str) : data(str) {}
+        explicit Json(const String &str) : data(str) {}
+
+        explicit Json(String &&str) : data(std::move(str)) {}
+
+        explicit Json(const std::string &str) : data(std::in_place_type<String>, str) {}
 
-        explicit Json(std::string &&str) : data(std::move(str)) {}
+        explicit Json(const StringView view) : data(view) {}
 
         explicit Json(const Object &obj) : data(obj) {}
 
@@ -68,8 +111,94 @@ namespace Json {
 
         explicit Json(const Number num) : data(num) {}
 
+        explicit Json(const Integer num) : data(num) {}
+
+        explicit Json(const Unsigned num) : data(num) {}
+
         explicit Json(const Bool b) : data(b) {}
 
-        [[nodiscard]] std::string deserialize();
+        // presize runs a sizing pass first so the result is allocated exactly once.
+        [[nodiscard]] std::string deserialize(Format format = Format::PRETTY, bool presize = false,
+                                              MemberOrder order = MemberOrder::SORTED) const;
+
+        // Compares values the way JSON Patch "test" does: numbers by value whatever their alternative,
+        // strings whether owned or viewed, objects regardless of member order.
+        friend bool operator==(const Json &a, const Json &b);
+    };
+
+    // Documents keep the source text of values by their address, which holds only because moving a container
+    // hands over its storage and never copies the values in it.
+    static_assert(std::is_nothrow_move_constructible_v<Json>);
+
+    // A Json together with the text it was parsed from. String values without escapes are views into that
+    // text and escaped ones are decoded in place, so the text is shared by copies and never handed back.
+    class Document {
+    private:
+        std::shared_ptr<std::string> buffer;
+        Json root;
+
+        // Text of every value below root that is unchanged since parseJsonPreserving, empty for other documents.
+        // The root is moved along with the Document, so its text is kept apart.
+        std::unordered_map<const Json *, StringView> sources;
+        StringView rootSource;
+
+        // Gives every value of to, a copy of from, the source text of the same value of from.
+        void copySources(const Json &from, const Json &to, const Document &other);
+
+        // Drops the source text of json and everything below it from sources.
+        static void forgetSources(std::unordered_map<const Json *, StringView> &sources, const Json &json);
+
+        friend struct Builder;
+
+        friend Document parseJsonPreserving(std::string str);
+
+    public:
+        Document(std::shared_ptr<std::string> buffer, Json root) : buffer(std::move(buffer)), root(std::move(root)) {}
+
+        Document(const Document &other) : buffer(other.buffer), root(other.root), rootSource(other.rootSource) {
+            copySources(other.root, root, other);
+        }
+
+        Document(Document &&other) = default;
+
+        Document &operator=(const Document &other) {
+            if (this != &other) {
+                buffer = other.buffer;
+                root = other.root;
+                rootSource = other.rootSource;
+                sources.clear();
+                copySources(other.root, root, other);
+            }
+            return *this;
+        }
+
+        Document &operator=(Document &&other) = default;
+
+        // Anything may be changed through the non-const root, so getting it drops all kept source text.
+        // Use edit() to change one value and keep the text of the rest.
+        decltype(auto) getRoot(this auto &&self) {
+            if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)>>) {
+                self.sources.clear();
+                self.rootSource = {};
+            }
+            return (self.root);
+        }
+
+        // The value at pointer, a JSON Pointer, for changing it. It and the values on the path to it lose
+        // their source text. Throws std::runtime_error when nothing is at pointer.
+        Json &edit(StringView pointer);
+
+        // Text json was parsed from if it is a value of this Document unchanged since parseJsonPreserving,
+        // empty otherwise.
+        [[nodiscard]] StringView getSource(const Json &json) const;
+
+        // verbatim copies values with source text as they were parsed, so their formatting is the input's
+        // whatever format says. Only the values changed since are formatted, keeping their members in
+        // document order too.
+        [[nodiscard]] std::string deserialize(Format format = Format::PRETTY, bool verbatim = false) const;
+
+        [[nodiscard]] StringView getBuffer() const {
+            return *buffer;
+        }
     };
 }
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <concepts>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "JsonScanner.hpp"
+#include "JsonWriter.hpp"
+
+namespace Json {
+    // One member of a bound struct and the key it is read from and written to.
+    template<class Owner, class Member>
+    struct Field {
+        StringView name;
+        Member Owner::*member;
+    };
+
+    template<class Owner, class Member>
+    constexpr Field<Owner, Member> field(const StringView name, Member Owner::*member) {
+        return {name, member};
+    }
+
+    // Specialized by JSON_BIND with a tuple of Fields.
+    template<class T>
+    struct Binding;
+
+    template<class T>
+    concept Bound = requires { Binding<T>::fields; };
+
+    template<class T>
+    struct IsVector : std::false_type {};
+
+    template<class T>
+    struct IsVector<std::vector<T>> : std::true_type {};
+
+    template<class T>
+    struct IsOptional : std::false_type {};
+
+    template<class T>
+    struct IsOptional<std::optional<T>> : std::true_type {};
+
+    // Reads Json text straight into bound structs, their members and vectors of them without building any
+    // Json. Keys with no field are skipped, fields whose key does not occur keep their value.
+    struct BindReader : Scanner {
+        using Scanner::Scanner;
+
+        std::string scratch;
+
+        void expect(const Signal actual, const Signal expected, const char *what) {
+            if (actual != expected) {
+                throw std::runtime_error(std::string("Invalid Json Format, expected ") + what);
+            }
+        }
+
+        template<class T>
+        void read(T &out) {
+            const Signal next = nextType();
+            if constexpr (std::is_same_v<T, bool>) {
+                expect(next, Signal::BOOL, "a bool");
+                out = readBool();
+            } else if constexpr (std::is_integral_v<T>) {
+                expect(next, Signal::NUMBER, "an integer");
+                const auto number = readNumber();
+                const bool fits = std::visit([&out](const auto value) {
+                    if constexpr (std::is_integral_v<decltype(value)>) {
+                        if (std::in_range<T>(value)) {
+                            out = static_cast<T>(value);
+                            return true;
+                        }
+                    }
+                    return false;
+                }, number);
+                if (!fits) {
+                    throw std::runtime_error("Invalid Json Format, number does not fit the bound integer");
+                }
+            } else if constexpr (std::is_floating_point_v<T>) {
+                expect(next, Signal::NUMBER, "a number");
+                out = std::visit([](const auto value) { return static_cast<T>(value); }, readNumber());
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                expect(next, Signal::STRING, "a string");
+                out.clear();
+                readStringTo(out);
+            } else if constexpr (IsOptional<T>::value) {
+                if (next == Signal::NULLPTR) {
+                    readNull();
+                    out.reset();
+                } else {
+                    read(out.emplace());
+                }
+            } else if constexpr (IsVector<T>::value) {
+                expect(next, Signal::ARRAY, "an array");
+                pos++;
+                out.clear();
+                while (nextType() != Signal::ArrayEnd) {
+                    if constexpr (std::is_same_v<T, std::vector<bool>>) {
+                        // Elements of std::vector<bool> are proxies, not bool lvalues.
+                        bool element = false;
+                        read(element);
+                        out.push_back(element);
+                    } else {
+                        read(out.emplace_back());
+                    }
+                }
+                pos++;
+            } else {
+                static_assert(Bound<T>, "JsonBind, the member type has no JSON_BIND");
+                expect(next, Signal::OBJECT, "an object");
+                pos++;
+                for (Signal key; (key = nextType()) != Signal::ObjectEnd;) {
+                    expect(key, Signal::STRING, "a string key");
+                    readMember(out, readStringBorrowed(scratch));
+                }
+                pos++;
+            }
+        }
+
+        // The field list is unrolled at compile time into one comparison per field.
+        template<Bound T>
+        void readMember(T &out, const StringView key) {
+            const bool found = std::apply([&](const auto &... fields) {
+                return ((fields.name == key && (read(out.*fields.member), true)) || ...);
+            }, Binding<T>::fields);
+            if (!found) {
+                nextType();
+                skipValue();
+            }
+        }
+    };
+
+    // Writes bound structs with the layout Writer gives the equivalent Json in MemberOrder::INSERTION,
+    // fields come in the order they are bound.
+    class BindWriter : public Writer {
+    public:
+        using Writer::Writer;
+
+        template<class T>
+        BindWriter &write(const T &value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                (*this)(Bool{value});
+            } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+                (*this)(static_cast<Unsigned>(value));
+            } else if constexpr (std::is_integral_v<T>) {
+                (*this)(static_cast<Integer>(value));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                (*this)(static_cast<Number>(value));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                (*this)(StringView(value));
+            } else if constexpr (IsOptional<T>::value) {
+                if (value) {
+                    write(*value);
+                } else {
+                    (*this)(nullptr);
+                }
+            } else if constexpr (IsVector<T>::value) {
+                if (value.empty()) {
+                    append("[]");
+                    return *this;
+                }
+                openContainer('[');
+                for (size_t i = 0; i < value.size(); i++) {
+                    if (i != 0) separator();
+                    write(value[i]);
+                }
+                closeContainer(']');
+            } else {
+                static_assert(Bound<T>, "JsonBind, the member type has no JSON_BIND");
+                if constexpr (std::tuple_size_v<decltype(Binding<T>::fields)> == 0) {
+                    append("{}");
+                } else {
+                    openContainer('{');
+                    bool first = true;
+                    std::apply([&](const auto &... fields) {
+                        ((first ? void(first = false) : separator(), writeEscaped(fields.name), colon(),
+                                write(value.*fields.member)), ...);
+                    }, Binding<T>::fields);
+                    closeContainer('}');
+                }
+            }
+            return *this;
+        }
+    };
+
+    template<Bound T>
+    void parseJsonBound(const StringView str, T &out) {
+        withStructuralIndex(str, [&](const StructuralIndex *index) {
+            BindReader(str, index).read(out);
+        });
+    }
+
+    template<Bound T>
+    T parseJsonBound(const StringView str) {
+        T out{};
+        parseJsonBound(str, out);
+        return out;
+    }
+
+    template<Bound T>
+    std::string serializeBound(const T &value, const Format format = Format::PRETTY) {
+        BindWriter writer(format);
+        writer.write(value);
+        return std::move(writer.output());
+    }
+}
+
+// Member of the struct being bound, read from and written to the key of the same name.
+#define JSON_FIELD(member) ::Json::field(#member, &BoundType::member)
+
+// Binds Type to Json objects, e.g. JSON_BIND(Point, JSON_FIELD(x), JSON_FIELD(y)). Fields with another key are
+// written ::Json::field("key", &BoundType::member). Has to be used at global scope.
+#define JSON_BIND(Type, ...)                                                  \
+    template<>                                                                \
+    struct Json::Binding<Type> {                                              \
+        using BoundType = Type;                                               \
+        static constexpr auto fields = std::make_tuple(__VA_ARGS__);          \
+    };
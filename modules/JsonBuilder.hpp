@@ -0,0 +1,188 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Json.hpp"
+
+namespace Json {
+    // Sax handler that assembles the Json tree. Containers being filled wait on a stack until they end.
+    struct Builder {
+        struct Frame {
+            Json container;
+            bool isObject;
+            // The key of the object member whose value is being read.
+            Key key;
+            // Position and source text of the children, put into sources once the container has ended.
+            std::vector<std::pair<size_t, StringView>> sources{};
+        };
+
+        // Every container and owned string of the result is allocated from here.
+        std::pmr::memory_resource *resource;
+
+        // Insitu parsing, string values stay views of the input.
+        bool keepViews;
+
+        // Object keys are interned here when set.
+        KeyPool *keys = nullptr;
+
+        // Every value's source text goes here when set. Values only get their final address when their
+        // container has ended, the root's text is kept apart.
+        std::unordered_map<const Json *, StringView> *sources = nullptr;
+        StringView rootSource;
+
+        std::vector<Frame> stack;
+        Json root;
+
+        // Position in its container of the value added last, source() belongs to it.
+        size_t added = 0;
+
+        Builder(std::pmr::memory_resource *resource, const bool keepViews) : resource(resource), keepViews(keepViews) {}
+
+        void add(Json &&value) {
+            if (stack.empty()) {
+                root = std::move(value);
+                return;
+            }
+            Frame &top = stack.back();
+            if (top.isObject) {
+                Object &object = top.container.get<Object>();
+                if (sources) {
+                    // A repeated key replaces the value, which takes its text along.
+                    if (const auto it = object.find(top.key.view()); it != object.end()) {
+                        Document::forgetSources(*sources, it->second);
+                    }
+                }
+                const auto it = object.insert_or_assign(std::move(top.key), std::move(value)).first;
+                added = static_cast<size_t>(it - object.begin());
+            } else {
+                Array &array = top.container.get<Array>();
+                array.emplace_back(std::move(value));
+                added = array.size() - 1;
+            }
+        }
+
+        void source(const StringView text) {
+            if (!sources) {
+                return;
+            }
+            if (stack.empty()) {
+                rootSource = text;
+            } else {
+                stack.back().sources.emplace_back(added, text);
+            }
+        }
+
+        void startObject() {
+            stack.push_back({Json{Object(resource)}, true, Key(resource)});
+        }
+
+        void startArray() {
+            stack.push_back({Json{Array(resource)}, false, Key(resource)});
+        }
+
+        void endObject() {
+            Frame &top = stack.back();
+            for (const auto &[position, text]: top.sources) {
+                const Json &child = top.isObject ? (top.container.get<Object>().begin() + position)->second
+                                                 : top.container.get<Array>()[position];
+                (*sources)[&child] = text;
+            }
+            Json container = std::move(top.container);
+            stack.pop_back();
+            add(std::move(container));
+        }
+
+        void endArray() {
+            endObject();
+        }
+
+        void key(const StringView text) {
+            stack.back().key = keys ? keys->intern(text) : Key(text, resource);
+        }
+
+        void string(const StringView text) {
+            if (keepViews) {
+                add(Json{text});
+            } else {
+                add(Json{String(text, resource)});
+            }
+        }
+
+        void number(const auto value) {
+            add(Json{value});
+        }
+
+        void boolean(const Bool value) {
+            add(Json{value});
+        }
+
+        void null() {
+            add(Json{});
+        }
+    };
+
+    // Sax handler for the node types besides Json, which are built from their containers and scalars alone.
+    template<class Node, class NodeObject, class NodeArray>
+    struct NodeBuilder {
+        struct Frame {
+            Node container;
+            bool isObject;
+            Key key;
+        };
+
+        std::vector<Frame> stack;
+        Node root;
+
+        void add(Node &&value) {
+            if (stack.empty()) {
+                root = std::move(value);
+                return;
+            }
+            Frame &top = stack.back();
+            if (top.isObject) {
+                top.container.template get<Object>().insert_or_assign(std::move(top.key), std::move(value));
+            } else {
+                top.container.template get<Array>().push_back(std::move(value));
+            }
+        }
+
+        void startObject() {
+            stack.push_back({Node{NodeObject()}, true, Key()});
+        }
+
+        void startArray() {
+            stack.push_back({Node{NodeArray()}, false, Key()});
+        }
+
+        void endObject() {
+            Node container = std::move(stack.back().container);
+            stack.pop_back();
+            add(std::move(container));
+        }
+
+        void endArray() {
+            endObject();
+        }
+
+        void key(const StringView text) {
+            stack.back().key = Key(text);
+        }
+
+        void string(const StringView text) {
+            add(Node{text});
+        }
+
+        void number(const auto value) {
+            add(Node{value});
+        }
+
+        void boolean(const Bool value) {
+            add(Node{value});
+        }
+
+        void null() {
+            add(Node{});
+        }
+    };
+}
@@ -1,17 +1,29 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
-#include <map>
+#include <string_view>
+#include <memory_resource>
 #include <vector>
 #include <typeinfo>
+#include "FlatMap.hpp"
+#include "KeyPool.hpp"
 
 namespace Json {
     class Json;
+    class Document;
 
-    using String = std::string;
-    using Object = std::map<String, Json>;
-    using Array = std::vector<Json>;
+    // Containers take their memory from a std::pmr::memory_resource, the default one unless the document was
+    // parsed into a specific resource. Copies always go back to the default resource.
+    // Objects iterate their members in insertion order, writers still put them out sorted unless told otherwise.
+    using String = std::pmr::string;
+    using StringView = std::string_view;
+    using Object = FlatMap<Key, Json>;
+    using Array = std::pmr::vector<Json>;
     using Number = double;
+    // Numbers without a fraction or exponent are kept exact. Unsigned only holds values above INT64_MAX.
+    using Integer = std::int64_t;
+    using Unsigned = std::uint64_t;
     using Bool = bool;
     using NullPtr = std::nullptr_t;
 
@@ -21,9 +33,44 @@ namespace Json {
         ARRAY,
         NUMBER,
         BOOL,
-        NULLPTR
+        NULLPTR,
+        INTEGER,
+        UNSIGNED
+    };
+
+    // PRETTY puts every member and element on its own line, indented by two spaces per level.
+    enum class Format {
+        PRETTY,
+        COMPACT
+    };
+
+    // Order writers put object members in. SORTED is by key, as when objects were std::maps, INSERTION is the
+    // order the members were parsed or inserted in.
+    enum class MemberOrder {
+        SORTED,
+        INSERTION
     };
 
     Json parseJson(const std::string &str);
+
+    // Builds every string, object and array of the result from resource. Together with a
+    // std::pmr::monotonic_buffer_resource a whole document is freed by one release() of the resource,
+    // after the Json itself is gone.
+    Json parseJson(const std::string &str, std::pmr::memory_resource *resource);
     Json parseJsonFromFile(const std::string &fileName);
+
+    // Object keys of the result are handles into keys instead of copies, see KeyPool.
+    Json parseJson(const std::string &str, KeyPool &keys);
+
+    // For a document that is one big top-level array: the elements are parsed on threads worker threads
+    // (0 means one per hardware thread) and kept in input order. Any other document is parsed as by parseJson.
+    Json parseJsonParallel(const std::string &str, size_t threads = 0);
+
+    // Takes ownership of the text, strings of the result point into it instead of being copied.
+    Document parseJsonInsitu(std::string str);
+
+    // Takes ownership of the text and remembers the part of it every value was parsed from, until the value is
+    // changed through Document::edit. Document::deserialize with verbatim copies unchanged values from that text,
+    // so only the changed parts are formatted again.
+    Document parseJsonPreserving(std::string str);
 }
\ No newline at end of file
@@ -1,201 +1,170 @@
+#include <charconv>
 #include <stdexcept>
-#include <fstream>
-#include <sstream>
+#include <utility>
 #include "JsonForwardHeader.hpp"
 #include "Json.hpp"
+#include "JsonBuilder.hpp"
+#include "JsonPath.hpp"
+#include "JsonSax.hpp"
+#include "MappedFile.hpp"
 
 namespace Json {
-    struct Builder {
-        const std::string_view sv;
-        size_t pos = 0;
+    Json buildIndexed(const std::string_view sv, char *insitu, std::pmr::memory_resource *resource,
+                      KeyPool *keys = nullptr) {
+        Builder builder(resource, insitu != nullptr);
+        builder.keys = keys;
+        withStructuralIndex(sv, [&](const StructuralIndex *index) {
+            SaxReader reader(sv, index, builder);
+            reader.insitu = insitu;
+            reader.readValue();
+        });
+        return std::move(builder.root);
+    }
 
-        explicit Builder(const std::string_view &sv) : sv(sv) {}
+    Json parseJson(const std::string &str) {
+        return buildIndexed(str, nullptr, std::pmr::get_default_resource());
+    }
 
-        char now() {
-            return sv[pos];
-        }
+    Json parseJson(const std::string &str, std::pmr::memory_resource *resource) {
+        return buildIndexed(str, nullptr, resource);
+    }
 
-        enum class Signal {
-            STRING,
-            OBJECT,
-            ARRAY,
-            NUMBER,
-            BOOL,
-            NULLPTR,
-            ObjectEnd,
-            ArrayEnd
-        };
+    Json parseJson(const std::string &str, KeyPool &keys) {
+        return buildIndexed(str, nullptr, std::pmr::get_default_resource(), &keys);
+    }
 
-        Signal nextType() {
-            while (pos < sv.size()) {
-                switch (now()) {
-                    case '"':
-                        return Signal::STRING;
-                    case '{':
-                        return Signal::OBJECT;
-                    case '[':
-                        return Signal::ARRAY;
-                    case 't':
-                    case 'f':
-                        return Signal::BOOL;
-                    case 'n':
-                        return Signal::NULLPTR;
-                    case '-':
-                    case '+':
-                    case '.':
-                    case '0':
-                    case '1':
-                    case '2':
-                    case '3':
-                    case '4':
-                    case '5':
-                    case '6':
-                    case '7':
-                    case '8':
-                    case '9':
-                        return Signal::NUMBER;
-                    case '}':
-                        return Signal::ObjectEnd;
-                    case ']':
-                        return Signal::ArrayEnd;
-                    default:
-                        break;
-                }
-                pos++;
-            }
-            throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
-        }
+    Document parseJsonInsitu(std::string str) {
+        auto buffer = std::make_shared<std::string>(std::move(str));
+        Json root = buildIndexed(*buffer, buffer->data(), std::pmr::get_default_resource());
+        return {std::move(buffer), std::move(root)};
+    }
 
-        template<class Type = void>
-        Json build() {
-            switch (nextType()) {
-                case Signal::OBJECT:
-                    return build<Object>();
-                case Signal::ARRAY:
-                    return build<Array>();
-                case Signal::STRING:
-                    return build<String>();
-                case Signal::NUMBER:
-                    return build<Number>();
-                case Signal::BOOL:
-                    return build<Bool>();
-                case Signal::NULLPTR:
-                    return build<NullPtr>();
-                default:
-                    throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
-            }
-        }
+    Document parseJsonPreserving(std::string str) {
+        auto buffer = std::make_shared<std::string>(std::move(str));
+        Builder builder(std::pmr::get_default_resource(), false);
+        std::unordered_map<const Json *, StringView> sources;
+        builder.sources = &sources;
+        parseJsonSax(*buffer, builder);
+        // Moving the root along hands over the storage of its containers, so the addresses stay valid.
+        Document document(std::move(buffer), std::move(builder.root));
+        document.sources = std::move(sources);
+        document.rootSource = builder.rootSource;
+        return document;
+    }
 
-        String readString() {
-            const static std::map<char, char> escapeMap = {
-                    {'"',  '"'},
-                    {'\\', '\\'},
-                    {'/',  '/'},
-                    {'b',  '\b'},
-                    {'f',  '\f'},
-                    {'n',  '\n'},
-                    {'r',  '\r'},
-                    {'t',  '\t'}
-            };
-            ++pos;
-            String res;
-            while (pos < sv.size() && now() != '"') {
-                if (now() == '\\') {
-                    pos++;
-                    res.push_back(escapeMap.at(now()));
-                } else {
-                    res.push_back(now());
-                }
-                pos++;
+    void Document::copySources(const Json &from, const Json &to, const Document &other) {
+        if (from.what() == DataType::OBJECT) {
+            auto target = to.get<Object>().begin();
+            for (const auto &[K, V]: from.get<Object>()) {
+                copySources(V, (target++)->second, other);
+            }
+        } else if (from.what() == DataType::ARRAY) {
+            auto target = to.get<Array>().begin();
+            for (const Json &element: from.get<Array>()) {
+                copySources(element, *target++, other);
             }
-            pos++;
-            return res;
         }
-
-        template<>
-        Json build<String>() {
-            return Json{readString()};
+        if (const auto it = other.sources.find(&from); it != other.sources.end()) {
+            sources.emplace(&to, it->second);
         }
+    }
 
-        template<>
-        Json build<Number>() {
-
-            size_t start = pos;
-            while (pos < sv.size() && (now() == '.' || (now() >= '0' && now() <= '9')
-                                       || (now() == '-') || (now() == '+')
-                                       || (now() == 'e'))) {
-                pos++;
+    void Document::forgetSources(std::unordered_map<const Json *, StringView> &sources, const Json &json) {
+        if (json.what() == DataType::OBJECT) {
+            for (const auto &[K, V]: json.get<Object>()) {
+                forgetSources(sources, V);
+            }
+        } else if (json.what() == DataType::ARRAY) {
+            for (const Json &element: json.get<Array>()) {
+                forgetSources(sources, element);
             }
-
-            return Json{std::stod(sv.substr(start, pos - start).data())};
         }
+        sources.erase(&json);
+    }
 
-        template<>
-        Json build<Bool>() {
-            if (sv.substr(pos, 4) == "true") {
-                pos += 4;
-                return Json{true};
-            } else if (sv.substr(pos, 5) == "false") {
-                pos += 5;
-                return Json{false};
+    Json &Document::edit(const StringView pointer) {
+        const std::vector<std::string> tokens = JsonPath::tokens(pointer);
+        rootSource = {};
+        Json *json = &root;
+        for (const std::string &token: tokens) {
+            if (json->what() == DataType::OBJECT) {
+                Object &object = json->get<Object>();
+                const auto it = object.find(token);
+                if (it == object.end()) {
+                    throw std::runtime_error("Invalid Json Pointer, no member \"" + token + "\"");
+                }
+                json = &it->second;
+            } else if (json->what() == DataType::ARRAY) {
+                Array &array = json->get<Array>();
+                size_t index = 0;
+                const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), index);
+                if (ec != std::errc{} || end != token.data() + token.size() || index >= array.size()) {
+                    throw std::runtime_error("Invalid Json Pointer, no element \"" + token + "\"");
+                }
+                json = &array[index];
             } else {
-                throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+                throw std::runtime_error("Invalid Json Pointer, \"" + token + "\" goes through a scalar");
             }
+            sources.erase(json);
         }
+        // Whatever is below may be replaced or reallocated, so its addresses must not be found again.
+        forgetSources(sources, *json);
+        return *json;
+    }
 
-        template<>
-        Json build<NullPtr>() {
-            if (sv.substr(pos, 4) == "null") {
-                pos += 4;
-                return {};
-            } else {
-                throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
-            }
+    StringView Document::getSource(const Json &json) const {
+        if (&json == &root) {
+            return rootSource;
         }
+        const auto it = sources.find(&json);
+        return it == sources.end() ? StringView{} : it->second;
+    }
 
-        template<>
-        Json build<Object>() {
-            Object obj;
-            pos++;
+    Json parseJsonFromFile(const std::string &filename) {
+        // Strings are copied out of the mapping while building, so it can go away once the tree is built.
+        const MappedFile file(filename);
+        return buildIndexed(file.view(), nullptr, std::pmr::get_default_resource());
+    }
 
-            while (nextType() != Signal::ObjectEnd) {
-                String str = readString();
-                obj[std::move(str)] = build();
+    bool operator==(const Json &a, const Json &b) {
+        const DataType typeA = a.what();
+        const DataType typeB = b.what();
+        const auto isNumeric = [](const DataType type) {
+            return type == DataType::NUMBER || type == DataType::INTEGER || type == DataType::UNSIGNED;
+        };
+        if (isNumeric(typeA) && isNumeric(typeB)) {
+            if (typeA == DataType::NUMBER || typeB == DataType::NUMBER) {
+                return a.getNumber() == b.getNumber();
             }
-
-            pos++;
-            return Json{std::move(obj)};
-        }
-
-        template<>
-        Json build<Array>() {
-            Array arr;
-            pos++;
-            while (nextType() != Signal::ArrayEnd) {
-                arr.push_back(build());
+            if (typeA == DataType::INTEGER) {
+                return typeB == DataType::INTEGER ? a.get<Integer>() == b.get<Integer>()
+                                                  : std::cmp_equal(a.get<Integer>(), b.get<Unsigned>());
             }
-            pos++;
-            return Json{std::move(arr)};
+            return typeB == DataType::UNSIGNED ? a.get<Unsigned>() == b.get<Unsigned>()
+                                               : std::cmp_equal(a.get<Unsigned>(), b.get<Integer>());
         }
-    };
-
-
-    Json parseJson(const std::string &str) {
-        return Builder(str).build();
-    }
-
-    std::string readFileIntoString(const std::string &filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            throw std::runtime_error("Could not open file " + filename);
+        if (typeA != typeB) {
+            return false;
+        }
+        switch (typeA) {
+            case DataType::STRING:
+                return a.getStringView() == b.getStringView();
+            case DataType::OBJECT: {
+                const Object &objectA = a.get<Object>();
+                const Object &objectB = b.get<Object>();
+                if (objectA.size() != objectB.size()) return false;
+                for (const auto &[K, V]: objectA) {
+                    const auto it = objectB.find(K.view());
+                    if (it == objectB.end() || !(V == it->second)) return false;
+                }
+                return true;
+            }
+            case DataType::ARRAY:
+                return a.get<Array>() == b.get<Array>();
+            case DataType::BOOL:
+                return a.get<Bool>() == b.get<Bool>();
+            default:
+                return true;
         }
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
-    }
-
-    Json parseJsonFromFile(const std::string &filename) {
-        return parseJson(readFileIntoString(filename));
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#include <cstring>
+#include "JsonBuilder.hpp"
+#include "JsonLines.hpp"
+#include "JsonSax.hpp"
+
+namespace Json {
+    namespace {
+        bool isBlank(const StringView line) {
+            return line.find_first_not_of(" \t\r") == StringView::npos;
+        }
+
+        std::vector<JsonLinesReader::Line> parseBatch(const StringView text) {
+            std::vector<JsonLinesReader::Line> documents;
+            size_t start = 0;
+            while (start < text.size()) {
+                size_t end = text.find('\n', start);
+                if (end == StringView::npos) {
+                    end = text.size();
+                }
+                const StringView line = text.substr(start, end - start);
+                if (!isBlank(line)) {
+                    // A bad line keeps its error, the lines around it are still parsed.
+                    JsonLinesReader::Line &parsed = documents.emplace_back();
+                    try {
+                        Builder builder(std::pmr::get_default_resource(), false);
+                        parseJsonSax(line, builder);
+                        parsed.document = std::move(builder.root);
+                    } catch (...) {
+                        parsed.error = std::current_exception();
+                    }
+                }
+                start = end + 1;
+            }
+            return documents;
+        }
+    }
+
+    JsonLinesReader::JsonLinesReader(std::istream &input, const size_t threads, const size_t batchLines)
+            : input(&input), batchLines(batchLines), pool(threads), maxInFlight(2 * pool.size()) {}
+
+    JsonLinesReader::JsonLinesReader(const StringView text, const size_t threads, const size_t batchLines)
+            : remaining(text), batchLines(batchLines), pool(threads), maxInFlight(2 * pool.size()) {}
+
+    std::optional<JsonLinesReader::Batch> JsonLinesReader::readBatch() {
+        Batch batch;
+        if (input) {
+            std::string line;
+            for (size_t lines = 0; lines < batchLines && std::getline(*input, line); lines++) {
+                batch.owned.append(line).push_back('\n');
+            }
+            if (batch.owned.empty()) {
+                return std::nullopt;
+            }
+            return batch;
+        }
+
+        if (remaining.empty()) {
+            return std::nullopt;
+        }
+        size_t end = 0;
+        for (size_t lines = 0; lines < batchLines && end < remaining.size(); lines++) {
+            const auto *newline = static_cast<const char *>(std::memchr(remaining.data() + end, '\n',
+                                                                        remaining.size() - end));
+            end = newline ? newline - remaining.data() + 1 : remaining.size();
+        }
+        batch.text = remaining.substr(0, end);
+        remaining.remove_prefix(end);
+        return batch;
+    }
+
+    void JsonLinesReader::fillPipeline() {
+        while (inFlight.size() < maxInFlight) {
+            std::optional<Batch> batch = readBatch();
+            if (!batch) {
+                return;
+            }
+            inFlight.push_back(pool.submit([work = std::move(*batch)] {
+                return parseBatch(work.owned.empty() ? work.text : StringView(work.owned));
+            }));
+        }
+    }
+
+    std::optional<Json> JsonLinesReader::next() {
+        while (currentIndex == current.size()) {
+            fillPipeline();
+            if (inFlight.empty()) {
+                return std::nullopt;
+            }
+            std::future<std::vector<Line>> front = std::move(inFlight.front());
+            inFlight.pop_front();
+            current = front.get();
+            currentIndex = 0;
+        }
+        Line &line = current[currentIndex++];
+        if (line.error) {
+            std::rethrow_exception(line.error);
+        }
+        return std::move(line.document);
+    }
+
+    void parseJsonLines(std::istream &input, const std::function<void(Json &&)> &onDocument, const size_t threads) {
+        JsonLinesReader reader(input, threads);
+        while (std::optional<Json> document = reader.next()) {
+            onDocument(std::move(*document));
+        }
+    }
+
+    void parseJsonLines(const StringView text, const std::function<void(Json &&)> &onDocument, const size_t threads) {
+        JsonLinesReader reader(text, threads);
+        while (std::optional<Json> document = reader.next()) {
+            onDocument(std::move(*document));
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <istream>
+#include <optional>
+#include <vector>
+#include "Json.hpp"
+#include "ThreadPool.hpp"
+
+namespace Json {
+    // Reader for JSON Lines / NDJSON, one document per line. Batches of lines are parsed concurrently on a
+    // thread pool while next() hands the documents out in input order. Blank lines are skipped.
+    class JsonLinesReader {
+    public:
+        // A parsed line, error is set instead of document when it failed to parse.
+        struct Line {
+            Json document;
+            std::exception_ptr error;
+        };
+
+    private:
+        struct Batch {
+            // Lines copied out of a stream, empty when the batch is a slice of the caller's text.
+            std::string owned;
+            StringView text;
+        };
+
+        std::istream *input = nullptr;
+        StringView remaining;
+        size_t batchLines;
+
+        ThreadPool pool;
+        // At most maxInFlight batches are read ahead, which bounds the memory held for a long input.
+        size_t maxInFlight;
+        std::deque<std::future<std::vector<Line>>> inFlight;
+
+        std::vector<Line> current;
+        size_t currentIndex = 0;
+
+        std::optional<Batch> readBatch();
+
+        void fillPipeline();
+
+    public:
+        // 0 threads means one per hardware thread.
+        explicit JsonLinesReader(std::istream &input, size_t threads = 0, size_t batchLines = 1024);
+
+        // text has to outlive the reader, its lines are parsed without being copied.
+        explicit JsonLinesReader(StringView text, size_t threads = 0, size_t batchLines = 1024);
+
+        // The next document in input order, std::nullopt once the input is exhausted. A line that fails to
+        // parse rethrows its error here when its turn comes, the next call goes on with the line after it.
+        std::optional<Json> next();
+    };
+
+    // Calls onDocument with every document of the input, in input order, on the calling thread.
+    void parseJsonLines(std::istream &input, const std::function<void(Json &&)> &onDocument, size_t threads = 0);
+
+    void parseJsonLines(StringView text, const std::function<void(Json &&)> &onDocument, size_t threads = 0);
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <vector>
+#include "JsonBuilder.hpp"
+#include "JsonForwardHeader.hpp"
+#include "JsonSax.hpp"
+#include "JsonWriter.hpp"
+#include "ThreadPool.hpp"
+
+namespace Json {
+    namespace {
+        // Every range handed to a worker should be about this many bytes or more, smaller ones are not worth a task.
+        constexpr size_t minimumRangeSize = 64 * 1024;
+
+        // How many ranges each worker gets, so one slow range does not leave the others idle.
+        constexpr size_t rangesPerThread = 4;
+
+        // Tokens of the top-level array: indices into positions of every element start and of the closing
+        // bracket. starts is empty when the document is not an array.
+        struct TopLevelArray {
+            std::vector<size_t> starts;
+            size_t close = 0;
+        };
+
+        TopLevelArray findElementStarts(const std::string_view sv, const std::vector<StructuralIndex::Position> &positions) {
+            TopLevelArray array;
+            if (positions.empty() || sv[positions[0]] != '[') {
+                return array;
+            }
+
+            size_t depth = 0;
+            for (size_t token = 0; token < positions.size(); token++) {
+                const char c = sv[positions[token]];
+                if (depth == 1 && c != ']' && c != '}') {
+                    array.starts.push_back(token);
+                }
+                if (c == '[' || c == '{') {
+                    depth++;
+                } else if (c == ']' || c == '}') {
+                    if (depth <= 1) {
+                        array.close = token;
+                        return array;
+                    }
+                    depth--;
+                }
+            }
+            throw std::runtime_error("Invalid Json Format, unterminated array");
+        }
+
+        // Containers with fewer children are written on the calling thread.
+        constexpr size_t minimumParallelChildren = 1024;
+
+        // Every chunk handed to a worker should hold at least this many children.
+        constexpr size_t minimumChunkChildren = 256;
+
+        // Writer whose container punctuation is public, so chunks formatted on other threads can be spliced in
+        // exactly where the sequential writer would have written those children.
+        class SplicingWriter : public Writer {
+        public:
+            SplicingWriter(const Format format, const MemberOrder order, const size_t depth) : Writer(format, order) {
+                indent = depth;
+            }
+
+            [[nodiscard]] Format outputFormat() const {
+                return format;
+            }
+
+            [[nodiscard]] MemberOrder memberOrder() const {
+                return order;
+            }
+
+            [[nodiscard]] size_t depth() const {
+                return indent;
+            }
+
+            using Writer::append;
+            using Writer::openContainer;
+            using Writer::closeContainer;
+            using Writer::separator;
+            using Writer::colon;
+            using Writer::writeEscaped;
+        };
+
+        void writeSplit(SplicingWriter &writer, const Json &json, ThreadPool &pool);
+
+        void writeChild(SplicingWriter &writer, const Json &element, ThreadPool &pool) {
+            writeSplit(writer, element, pool);
+        }
+
+        void writeChild(SplicingWriter &writer, const Object::const_iterator member, ThreadPool &pool) {
+            writer.writeEscaped(member->first);
+            writer.colon();
+            writeSplit(writer, member->second, pool);
+        }
+
+        void writeChild(SplicingWriter &writer, const Json &element) {
+            writer.write(element);
+        }
+
+        void writeChild(SplicingWriter &writer, const Object::const_iterator member) {
+            writer.writeEscaped(member->first);
+            writer.colon();
+            writer.write(member->second);
+        }
+
+        // Container is an Array, or the iterators of an object's members in the order they are written in.
+        template<class Container>
+        void writeContainer(SplicingWriter &writer, const Container &container, const char open, const char close,
+                            ThreadPool &pool) {
+            writer.openContainer(open);
+            if (container.size() < minimumParallelChildren) {
+                bool first = true;
+                for (auto &&child: container) {
+                    if (!first) writer.separator();
+                    first = false;
+                    writeChild(writer, child, pool);
+                }
+                writer.closeContainer(close);
+                return;
+            }
+
+            const size_t chunkCount = std::min(pool.size() * rangesPerThread, container.size() / minimumChunkChildren);
+            const size_t chunkChildren = (container.size() + chunkCount - 1) / chunkCount;
+
+            std::vector<std::future<std::string>> chunks;
+            auto it = container.begin();
+            for (size_t first = 0; first < container.size(); first += chunkChildren) {
+                const auto begin = it;
+                const auto end = std::next(begin, static_cast<std::ptrdiff_t>(std::min(chunkChildren, container.size() - first)));
+                it = end;
+                chunks.push_back(pool.submit([begin, end, format = writer.outputFormat(), order = writer.memberOrder(),
+                                              depth = writer.depth()] {
+                    SplicingWriter chunk(format, order, depth);
+                    for (auto child = begin; child != end; ++child) {
+                        if (child != begin) chunk.separator();
+                        writeChild(chunk, *child);
+                    }
+                    return std::move(chunk.output());
+                }));
+            }
+
+            for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+                if (chunk != 0) writer.separator();
+                writer.append(chunks[chunk].get());
+            }
+            writer.closeContainer(close);
+        }
+
+        // Walks down to the containers large enough to split, everything else is written as it comes.
+        void writeSplit(SplicingWriter &writer, const Json &json, ThreadPool &pool) {
+            if (json.what() == DataType::ARRAY && !json.get<Array>().empty()) {
+                writeContainer(writer, json.get<Array>(), '[', ']', pool);
+            } else if (json.what() == DataType::OBJECT && !json.get<Object>().empty()) {
+                writeContainer(writer, writer.members(json.get<Object>()), '{', '}', pool);
+            } else {
+                writer.write(json);
+            }
+        }
+
+        Json parseSequential(const std::string_view sv, const StructuralIndex &index) {
+            Builder builder(std::pmr::get_default_resource(), false);
+            SaxReader(sv, &index, builder).readValue();
+            return std::move(builder.root);
+        }
+    }
+
+    Json parseJsonParallel(const std::string &str, const size_t threads) {
+        if (str.size() > StructuralIndex::maxInputSize) {
+            return parseJson(str);
+        }
+
+        const StructuralIndex index(str);
+        const auto &positions = index.positions();
+        const TopLevelArray array = findElementStarts(str, positions);
+        const std::vector<size_t> &starts = array.starts;
+        if (starts.size() < 2 || str.size() < 2 * minimumRangeSize) {
+            return parseSequential(str, index);
+        }
+
+        // Workers move their elements straight into the final array, so joining costs nothing. It is declared
+        // before the pool so that, whatever throws, the workers are joined before it goes away.
+        Array result(starts.size());
+
+        ThreadPool pool(threads);
+        const size_t rangeCount = std::min(pool.size() * rangesPerThread, str.size() / minimumRangeSize);
+        const size_t rangeBytes = str.size() / rangeCount;
+        std::vector<std::future<void>> pending;
+
+        size_t first = 0;
+        while (first < starts.size()) {
+            // Cut the range at the first element starting rangeBytes or more after this one.
+            const size_t limit = positions[starts[first]] + rangeBytes;
+            size_t last = first + 1;
+            while (last < starts.size() && positions[starts[last]] < limit) {
+                last++;
+            }
+
+            pending.push_back(pool.submit([&, first, last] {
+                Builder builder(std::pmr::get_default_resource(), false);
+                SaxReader reader(std::string_view(str), &index, builder);
+                reader.pos = positions[starts[first]];
+                reader.cursor = starts[first];
+                for (size_t element = first; element < last; element++) {
+                    reader.readValue();
+                    result[element] = std::move(builder.root);
+                }
+                // The elements have to end where the next range starts, or at the closing bracket.
+                reader.jumpToNextToken();
+                if (reader.cursor != (last < starts.size() ? starts[last] : array.close)) {
+                    throw std::runtime_error("Invalid Json Format, malformed array element");
+                }
+            }));
+            first = last;
+        }
+
+        // Every range has to finish before the first error is rethrown, the others still write into result.
+        std::exception_ptr failure;
+        for (std::future<void> &range: pending) {
+            try {
+                range.get();
+            } catch (...) {
+                if (!failure) failure = std::current_exception();
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        if (str.find_first_not_of(" \t\n\r", positions[array.close] + 1) != std::string::npos) {
+            throw std::runtime_error("Invalid Json Format, unexpected text after the array");
+        }
+        return Json{std::move(result)};
+    }
+
+    std::string serializeParallel(const Json &json, const Format format, const size_t threads, const MemberOrder order) {
+        ThreadPool pool(threads);
+        SplicingWriter writer(format, order, 0);
+        writeSplit(writer, json, pool);
+        return std::move(writer.output());
+    }
+}
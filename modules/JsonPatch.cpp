@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "JsonPatch.hpp"
+#include "JsonPath.hpp"
+
+namespace Json {
+    namespace {
+        using Tokens = std::vector<std::string>;
+
+        [[noreturn]] void fail(const std::string &what) {
+            throw std::runtime_error("Invalid Json Patch, " + what);
+        }
+
+        size_t arrayIndex(const std::string &token) {
+            if (token.empty() || token.size() > 19 || (token.size() > 1 && token[0] == '0')) {
+                fail("bad array index \"" + token + "\"");
+            }
+            size_t index = 0;
+            for (const char c: token) {
+                if (c < '0' || c > '9') fail("bad array index \"" + token + "\"");
+                index = index * 10 + (c - '0');
+            }
+            return index;
+        }
+
+        // The value the first count tokens lead to.
+        Json &resolve(Json &root, const Tokens &tokens, const size_t count) {
+            Json *json = &root;
+            for (size_t i = 0; i < count; i++) {
+                if (json->what() == DataType::OBJECT) {
+                    Object &object = json->get<Object>();
+                    const auto it = object.find(tokens[i]);
+                    if (it == object.end()) fail("no member \"" + tokens[i] + "\"");
+                    json = &it->second;
+                } else if (json->what() == DataType::ARRAY) {
+                    Array &array = json->get<Array>();
+                    const size_t index = arrayIndex(tokens[i]);
+                    if (index >= array.size()) fail("array index " + tokens[i] + " out of range");
+                    json = &array[index];
+                } else {
+                    fail("path goes through a scalar at \"" + tokens[i] + "\"");
+                }
+            }
+            return *json;
+        }
+
+        // Drops null members from objects, as merging into a missing member does.
+        void dropNulls(Json &json) {
+            if (json.what() != DataType::OBJECT) return;
+            Object &object = json.get<Object>();
+            for (auto it = object.begin(); it != object.end();) {
+                if (it->second.what() == DataType::NULLPTR) {
+                    it = object.erase(it);
+                } else {
+                    dropNulls(it->second);
+                    ++it;
+                }
+            }
+        }
+
+        // Changes a Json through paths and logs how to undo every change. The log refers to values by path,
+        // not by pointer, since later changes may move them.
+        class Patcher {
+        private:
+            struct Undo {
+                enum class Action {
+                    // Take out the member or element the path names.
+                    ERASE,
+                    // Put value back where the path points.
+                    RESTORE,
+                    // Put value back into the container, at position and with key for objects.
+                    INSERT
+                } action;
+                Tokens path;
+                Json value{};
+                Key key{};
+                size_t position = 0;
+                // INSERT the value the previous undo step took out instead, for values that were moved.
+                bool carried = false;
+            };
+
+            Json &root;
+            std::vector<Undo> log;
+
+            // Copies the path and makes room in the log first, so pushing the entry after the change cannot throw.
+            Undo prepare(const Undo::Action action, const Tokens &path) {
+                Undo undo{action, path};
+                log.reserve(log.size() + 1);
+                return undo;
+            }
+
+            Json &parentOf(const Tokens &path) {
+                if (path.empty()) fail("the whole document has no parent");
+                return resolve(root, path, path.size() - 1);
+            }
+
+        public:
+            explicit Patcher(Json &root) : root(root) {}
+
+            Json &get(const Tokens &path) {
+                return resolve(root, path, path.size());
+            }
+
+            void add(const Tokens &path, Json &&value) {
+                if (path.empty()) {
+                    replace(path, std::move(value));
+                    return;
+                }
+                Json &parent = parentOf(path);
+                const std::string &token = path.back();
+                if (parent.what() == DataType::OBJECT) {
+                    Object &object = parent.get<Object>();
+                    if (const auto it = object.find(token); it != object.end()) {
+                        Undo undo = prepare(Undo::Action::RESTORE, path);
+                        undo.value = std::move(it->second);
+                        it->second = std::move(value);
+                        log.push_back(std::move(undo));
+                    } else {
+                        Undo undo = prepare(Undo::Action::ERASE, path);
+                        object.try_emplace(StringView(token), std::move(value));
+                        log.push_back(std::move(undo));
+                    }
+                } else if (parent.what() == DataType::ARRAY) {
+                    Array &array = parent.get<Array>();
+                    const size_t index = token == "-" ? array.size() : arrayIndex(token);
+                    if (index > array.size()) fail("array index " + token + " out of range");
+                    Undo undo = prepare(Undo::Action::ERASE, path);
+                    undo.path.back() = std::to_string(index);
+                    array.insert(array.begin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+                    log.push_back(std::move(undo));
+                } else {
+                    fail("cannot add to a scalar");
+                }
+            }
+
+            void remove(const Tokens &path) {
+                Json &parent = parentOf(path);
+                const std::string &token = path.back();
+                Undo undo = prepare(Undo::Action::INSERT, path);
+                if (parent.what() == DataType::OBJECT) {
+                    Object &object = parent.get<Object>();
+                    const auto it = object.find(token);
+                    if (it == object.end()) fail("no member \"" + token + "\"");
+                    undo.position = static_cast<size_t>(it - object.begin());
+                    undo.key = it->first;
+                    undo.value = std::move(it->second);
+                    object.erase(it);
+                } else if (parent.what() == DataType::ARRAY) {
+                    Array &array = parent.get<Array>();
+                    const size_t index = arrayIndex(token);
+                    if (index >= array.size()) fail("array index " + token + " out of range");
+                    undo.position = index;
+                    undo.value = std::move(array[index]);
+                    array.erase(array.begin() + static_cast<std::ptrdiff_t>(index));
+                } else {
+                    fail("cannot remove from a scalar");
+                }
+                log.push_back(std::move(undo));
+            }
+
+            // The value changes place without being copied. Undoing the add takes it out again and undoing the
+            // remove puts that back.
+            void move(const Tokens &from, const Tokens &path) {
+                remove(from);
+                const size_t removed = log.size() - 1;
+                Json value = std::move(log[removed].value);
+                log[removed].carried = true;
+                try {
+                    add(path, std::move(value));
+                } catch (...) {
+                    log[removed].value = std::move(value);
+                    log[removed].carried = false;
+                    throw;
+                }
+            }
+
+            void replace(const Tokens &path, Json &&value) {
+                Json &json = get(path);
+                Undo undo = prepare(Undo::Action::RESTORE, path);
+                undo.value = std::move(json);
+                json = std::move(value);
+                log.push_back(std::move(undo));
+            }
+
+            void merge(Tokens &path, Json &&patch) {
+                if (patch.what() != DataType::OBJECT) {
+                    replace(path, std::move(patch));
+                    return;
+                }
+                Json &target = get(path);
+                if (target.what() != DataType::OBJECT) {
+                    replace(path, Json(Object{}));
+                }
+                for (auto &&[K, V]: patch.get<Object>()) {
+                    path.emplace_back(K.view());
+                    const bool exists = target.get<Object>().contains(K.view());
+                    if (V.what() == DataType::NULLPTR) {
+                        if (exists) remove(path);
+                    } else if (exists) {
+                        merge(path, std::move(V));
+                    } else {
+                        dropNulls(V);
+                        add(path, std::move(V));
+                    }
+                    path.pop_back();
+                }
+            }
+
+            // Undoes every logged change, latest first.
+            void rollback() {
+                Json carried;
+                for (auto it = log.rbegin(); it != log.rend(); ++it) {
+                    Undo &undo = *it;
+                    switch (undo.action) {
+                        case Undo::Action::RESTORE: {
+                            Json &json = get(undo.path);
+                            carried = std::move(json);
+                            json = std::move(undo.value);
+                            break;
+                        }
+                        case Undo::Action::ERASE: {
+                            Json &parent = parentOf(undo.path);
+                            if (parent.what() == DataType::OBJECT) {
+                                Object &object = parent.get<Object>();
+                                const auto member = object.find(undo.path.back());
+                                carried = std::move(member->second);
+                                object.erase(member);
+                            } else {
+                                Array &array = parent.get<Array>();
+                                const auto element = array.begin() + static_cast<std::ptrdiff_t>(arrayIndex(undo.path.back()));
+                                carried = std::move(*element);
+                                array.erase(element);
+                            }
+                            break;
+                        }
+                        case Undo::Action::INSERT: {
+                            Json &parent = parentOf(undo.path);
+                            Json value = std::move(undo.carried ? carried : undo.value);
+                            const auto position = static_cast<std::ptrdiff_t>(undo.position);
+                            if (parent.what() == DataType::OBJECT) {
+                                Object &object = parent.get<Object>();
+                                object.insert(object.begin() + position, std::move(undo.key), std::move(value));
+                            } else {
+                                Array &array = parent.get<Array>();
+                                array.insert(array.begin() + position, std::move(value));
+                            }
+                            break;
+                        }
+                    }
+                }
+                log.clear();
+            }
+        };
+
+        Json &member(Object &operation, const StringView name) {
+            const auto it = operation.find(name);
+            if (it == operation.end()) fail("operation without \"" + std::string(name) + "\"");
+            return it->second;
+        }
+
+        StringView stringMember(Object &operation, const StringView name) {
+            const Json &value = member(operation, name);
+            if (value.what() != DataType::STRING) fail("\"" + std::string(name) + "\" has to be a string");
+            return value.getStringView();
+        }
+
+        void applyOperation(Patcher &patcher, Object &operation) {
+            const StringView op = stringMember(operation, "op");
+            const StringView pointer = stringMember(operation, "path");
+            const Tokens path = JsonPath::tokens(pointer);
+            if (op == "add") {
+                patcher.add(path, std::move(member(operation, "value")));
+            } else if (op == "remove") {
+                if (path.empty()) fail("cannot remove the whole document");
+                patcher.remove(path);
+            } else if (op == "replace") {
+                patcher.replace(path, std::move(member(operation, "value")));
+            } else if (op == "move") {
+                const Tokens from = JsonPath::tokens(stringMember(operation, "from"));
+                if (from == path) {
+                    patcher.get(from);
+                    return;
+                }
+                if (from.size() < path.size() && std::equal(from.begin(), from.end(), path.begin())) {
+                    fail("cannot move \"" + std::string(pointer) + "\" into itself");
+                }
+                if (from.empty()) fail("cannot move the whole document");
+                patcher.move(from, path);
+            } else if (op == "copy") {
+                Json value = patcher.get(JsonPath::tokens(stringMember(operation, "from")));
+                patcher.add(path, std::move(value));
+            } else if (op == "test") {
+                if (!(patcher.get(path) == member(operation, "value"))) {
+                    fail("test failed at \"" + std::string(pointer) + "\"");
+                }
+            } else {
+                fail("unknown operation \"" + std::string(op) + "\"");
+            }
+        }
+    }
+
+    void applyPatch(Json &target, Json &&patch) {
+        if (patch.what() != DataType::ARRAY) {
+            fail("a patch is an array of operations");
+        }
+        Patcher patcher(target);
+        try {
+            for (Json &operation: patch.get<Array>()) {
+                if (operation.what() != DataType::OBJECT) fail("an operation is an object");
+                applyOperation(patcher, operation.get<Object>());
+            }
+        } catch (...) {
+            patcher.rollback();
+            throw;
+        }
+    }
+
+    void applyPatch(Json &target, const Json &patch) {
+        applyPatch(target, Json(patch));
+    }
+
+    void applyMergePatch(Json &target, Json &&patch) {
+        Patcher patcher(target);
+        Tokens path;
+        try {
+            patcher.merge(path, std::move(patch));
+        } catch (...) {
+            patcher.rollback();
+            throw;
+        }
+    }
+
+    void applyMergePatch(Json &target, const Json &patch) {
+        applyMergePatch(target, Json(patch));
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Json.hpp"
+
+namespace Json {
+    // Applies an RFC 6902 JSON Patch, an array of operations, to target in place. Only the containers on the
+    // paths of the operations are touched and values are moved out of the patch, not copied. If an operation
+    // fails, including a failed "test", everything done so far is undone and std::runtime_error is thrown,
+    // so target is left as it was. The patch itself is left unspecified then.
+    void applyPatch(Json &target, Json &&patch);
+
+    void applyPatch(Json &target, const Json &patch);
+
+    // Applies an RFC 7396 JSON Merge Patch to target in place, with the same guarantees as applyPatch.
+    void applyMergePatch(Json &target, Json &&patch);
+
+    void applyMergePatch(Json &target, const Json &patch);
+}
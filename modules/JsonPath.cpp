@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <stdexcept>
+#include "JsonPath.hpp"
+#include "JsonScanner.hpp"
+
+namespace Json {
+    using Signal = Scanner::Signal;
+
+    namespace {
+        // Index of an array segment: digits without leading zeros, as RFC 6901 has them.
+        size_t parseIndex(const StringView segment) {
+            if (segment.empty() || segment.size() > 19 || (segment.size() > 1 && segment[0] == '0')) {
+                return static_cast<size_t>(-1);
+            }
+            size_t index = 0;
+            for (const char c: segment) {
+                if (c < '0' || c > '9') return static_cast<size_t>(-1);
+                index = index * 10 + (c - '0');
+            }
+            return index;
+        }
+
+        // Walks the Json along steps, calling found for every match until it returns false.
+        template<class Steps, class Found>
+        bool walk(const Json &json, const Steps &steps, const size_t depth, Found &found) {
+            if (depth == steps.size()) {
+                return found(json);
+            }
+            const auto &step = steps[depth];
+            switch (json.what()) {
+                case DataType::OBJECT: {
+                    const Object &object = json.get<Object>();
+                    if (step.wildcard) {
+                        for (const auto &[K, V]: object) {
+                            if (!walk(V, steps, depth + 1, found)) return false;
+                        }
+                    } else if (const auto it = object.find(StringView(step.key)); it != object.end()) {
+                        return walk(it->second, steps, depth + 1, found);
+                    }
+                    return true;
+                }
+                case DataType::ARRAY: {
+                    const Array &array = json.get<Array>();
+                    if (step.wildcard) {
+                        for (const Json &element: array) {
+                            if (!walk(element, steps, depth + 1, found)) return false;
+                        }
+                    } else if (step.index < array.size()) {
+                        return walk(array[step.index], steps, depth + 1, found);
+                    }
+                    return true;
+                }
+                default:
+                    return true;
+            }
+        }
+
+        // Same over text, the scanner sits on the value. Values off the path are skipped by matching brackets.
+        // Returns false once found asked to stop, the scanner is left where it was then.
+        template<class Steps, class Found>
+        bool scan(Scanner &scanner, std::string &scratch, const Steps &steps, const size_t depth, Found &found) {
+            const Signal type = scanner.nextType();
+            if (depth == steps.size()) {
+                const size_t start = scanner.pos;
+                scanner.skipValue();
+                return found(scanner.sv.substr(start, scanner.pos - start));
+            }
+            const auto &step = steps[depth];
+            if (type == Signal::OBJECT) {
+                scanner.pos++;
+                for (Signal next; (next = scanner.nextType()) != Signal::ObjectEnd;) {
+                    if (next != Signal::STRING) {
+                        throw std::runtime_error("Invalid Json Format, object keys must be strings");
+                    }
+                    const bool match = step.wildcard || scanner.readStringBorrowed(scratch) == step.key;
+                    if (step.wildcard) {
+                        scanner.skipString();
+                    }
+                    if (match) {
+                        if (!scan(scanner, scratch, steps, depth + 1, found)) return false;
+                    } else {
+                        scanner.nextType();
+                        scanner.skipValue();
+                    }
+                }
+                scanner.pos++;
+            } else if (type == Signal::ARRAY) {
+                scanner.pos++;
+                for (size_t i = 0; scanner.nextType() != Signal::ArrayEnd; i++) {
+                    if (step.wildcard || i == step.index) {
+                        if (!scan(scanner, scratch, steps, depth + 1, found)) return false;
+                    } else {
+                        scanner.skipValue();
+                    }
+                }
+                scanner.pos++;
+            } else if (type == Signal::ObjectEnd || type == Signal::ArrayEnd) {
+                throw std::runtime_error("Invalid Json Format, expected a value");
+            } else {
+                scanner.skipValue();
+            }
+            return true;
+        }
+    }
+
+    std::vector<std::string> JsonPath::tokens(const StringView pointer) {
+        std::vector<std::string> tokens;
+        if (pointer.empty()) {
+            return tokens;
+        }
+        if (pointer[0] != '/') {
+            throw std::runtime_error("Invalid Json Pointer, it has to start with '/'");
+        }
+        size_t begin = 1;
+        while (true) {
+            const size_t end = std::min(pointer.find('/', begin), pointer.size());
+            std::string &token = tokens.emplace_back();
+            for (size_t i = begin; i < end; i++) {
+                if (pointer[i] != '~') {
+                    token += pointer[i];
+                } else if (i + 1 < end && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+                    token += pointer[++i] == '0' ? '~' : '/';
+                } else {
+                    throw std::runtime_error("Invalid Json Pointer, '~' has to be followed by '0' or '1'");
+                }
+            }
+            if (end == pointer.size()) break;
+            begin = end + 1;
+        }
+        return tokens;
+    }
+
+    JsonPath::JsonPath(const StringView pointer) {
+        for (std::string &token: tokens(pointer)) {
+            // "*" has no escapes, so the unescaped token is the segment as written.
+            const bool wildcard = token == "*";
+            const size_t index = parseIndex(token);
+            steps.push_back({std::move(token), index, wildcard});
+        }
+    }
+
+    bool JsonPath::hasWildcard() const {
+        for (const Step &step: steps) {
+            if (step.wildcard) return true;
+        }
+        return false;
+    }
+
+    const Json *JsonPath::find(const Json &root) const {
+        const Json *match = nullptr;
+        auto found = [&match](const Json &json) {
+            match = &json;
+            return false;
+        };
+        walk(root, steps, 0, found);
+        return match;
+    }
+
+    std::vector<const Json *> JsonPath::select(const Json &root) const {
+        std::vector<const Json *> matches;
+        auto found = [&matches](const Json &json) {
+            matches.push_back(&json);
+            return true;
+        };
+        walk(root, steps, 0, found);
+        return matches;
+    }
+
+    std::optional<StringView> JsonPath::find(const StringView text) const {
+        std::optional<StringView> match;
+        auto found = [&match](const StringView raw) {
+            match = raw;
+            return false;
+        };
+        Scanner scanner(text);
+        std::string scratch;
+        scan(scanner, scratch, steps, 0, found);
+        return match;
+    }
+
+    std::vector<StringView> JsonPath::select(const StringView text) const {
+        std::vector<StringView> matches;
+        auto found = [&matches](const StringView raw) {
+            matches.push_back(raw);
+            return true;
+        };
+        Scanner scanner(text);
+        std::string scratch;
+        scan(scanner, scratch, steps, 0, found);
+        return matches;
+    }
+}
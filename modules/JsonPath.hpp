@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "Json.hpp"
+
+namespace Json {
+    // A JSON Pointer (RFC 6901) compiled once and evaluated any number of times, e.g. "/users/0/name".
+    // A "*" segment matches every member of an object or every element of an array. It can be evaluated
+    // against a Json or straight against text, where everything off the path is skipped without parsing it.
+    // In text every occurrence of a duplicated key matches, a Json only keeps the last one.
+    class JsonPath {
+    private:
+        struct Step {
+            // Unescaped segment, also used as the key for numeric segments on objects.
+            std::string key;
+            // Array index, npos when the segment is not one.
+            size_t index;
+            bool wildcard;
+        };
+
+        std::vector<Step> steps;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    public:
+        // Throws std::runtime_error for pointers that are neither empty nor start with '/', or with a '~'
+        // not followed by '0' or '1'.
+        explicit JsonPath(StringView pointer);
+
+        // Unescaped reference tokens of a pointer, "*" included, with the same errors as the constructor.
+        static std::vector<std::string> tokens(StringView pointer);
+
+        [[nodiscard]] size_t size() const {
+            return steps.size();
+        }
+
+        [[nodiscard]] bool hasWildcard() const;
+
+        // First match in document order, nullptr when nothing matches.
+        [[nodiscard]] const Json *find(const Json &root) const;
+
+        [[nodiscard]] std::vector<const Json *> select(const Json &root) const;
+
+        // Raw text of the first match, scanning stops there.
+        [[nodiscard]] std::optional<StringView> find(StringView text) const;
+
+        [[nodiscard]] std::vector<StringView> select(StringView text) const;
+    };
+}
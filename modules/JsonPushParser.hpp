@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "JsonBuilder.hpp"
+#include "JsonSax.hpp"
+
+namespace Json {
+    // Incremental parser for text that arrives in pieces. Chunks may split the input anywhere, including in
+    // the middle of a token: only the bytes of a token cut by a chunk boundary are kept until the next chunk.
+    // Events go to handler as soon as their token is complete.
+    template<SaxHandler Handler>
+    class SaxPushParser {
+    private:
+        enum class State {
+            ExpectValue,
+            ExpectValueOrArrayEnd,
+            ExpectKeyOrObjectEnd,
+            ExpectKey,
+            ExpectColon,
+            ExpectCommaOrEnd,
+            InString,
+            InScalar,
+            Done
+        };
+
+        Handler &handler;
+        State state = State::ExpectValue;
+
+        // '{' or '[' for every open container.
+        std::vector<char> containers;
+
+        // Raw bytes of the token cut by the last chunk boundary, empty otherwise.
+        std::string token;
+        bool stringIsKey = false;
+        bool escapeOpen = false;
+
+        std::string scratch;
+
+        static bool isWhitespace(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        static bool isScalarChar(const char c) {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+        }
+
+        void afterValue() {
+            state = containers.empty() ? State::Done : State::ExpectCommaOrEnd;
+        }
+
+        void closeContainer(const char open) {
+            if (containers.empty() || containers.back() != open) {
+                throw std::runtime_error("Invalid Json Format, mismatched closing bracket");
+            }
+            containers.pop_back();
+            if (open == '{') {
+                handler.endObject();
+            } else {
+                handler.endArray();
+            }
+            afterValue();
+        }
+
+        // Returns where the raw text of the token ending at end starts, joining it with the spilled bytes.
+        StringView completeToken(const StringView chunk, const size_t tokenStart, const size_t end) {
+            if (token.empty()) {
+                return chunk.substr(tokenStart, end - tokenStart);
+            }
+            token.append(chunk.data() + tokenStart, end - tokenStart);
+            return token;
+        }
+
+        void beginValue(const StringView chunk, size_t &i) {
+            const char c = chunk[i];
+            switch (c) {
+                case '{':
+                    handler.startObject();
+                    containers.push_back('{');
+                    state = State::ExpectKeyOrObjectEnd;
+                    i++;
+                    return;
+                case '[':
+                    handler.startArray();
+                    containers.push_back('[');
+                    state = State::ExpectValueOrArrayEnd;
+                    i++;
+                    return;
+                case '"':
+                    stringIsKey = false;
+                    state = State::InString;
+                    return;
+                default:
+                    if (!isScalarChar(c)) {
+                        throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+                    }
+                    state = State::InScalar;
+                    return;
+            }
+        }
+
+        // Scans the string starting at tokenStart, its opening quote when it starts in this chunk.
+        size_t scanString(const StringView chunk, const size_t tokenStart) {
+            size_t i = token.empty() ? tokenStart + 1 : tokenStart;
+            const char *end = chunk.data() + chunk.size();
+            // The next quote is looked up again only once an escape has taken the scan past it, so strings with
+            // many escapes are not searched to their end for every one of them.
+            const char *quote = nullptr;
+            bool quoteKnown = false;
+            while (i < chunk.size()) {
+                if (escapeOpen) {
+                    escapeOpen = false;
+                    i++;
+                    continue;
+                }
+                const char *begin = chunk.data() + i;
+                if (!quoteKnown || (quote && quote < begin)) {
+                    quote = static_cast<const char *>(std::memchr(begin, '"', end - begin));
+                    quoteKnown = true;
+                }
+                const auto *backslash = static_cast<const char *>(std::memchr(begin, '\\', (quote ? quote : end) - begin));
+                if (backslash) {
+                    escapeOpen = true;
+                    i = backslash - chunk.data() + 1;
+                    continue;
+                }
+                if (!quote) {
+                    break;
+                }
+
+                const size_t after = quote - chunk.data() + 1;
+                Scanner scanner(completeToken(chunk, tokenStart, after));
+                const StringView text = scanner.readStringBorrowed(scratch);
+                if (stringIsKey) {
+                    handler.key(text);
+                    state = State::ExpectColon;
+                } else {
+                    handler.string(text);
+                    afterValue();
+                }
+                token.clear();
+                return after;
+            }
+            token.append(chunk.data() + tokenStart, chunk.size() - tokenStart);
+            return chunk.size();
+        }
+
+        void emitScalar(const StringView raw) {
+            Scanner scanner(raw);
+            switch (raw.front()) {
+                case 't':
+                case 'f':
+                    handler.boolean(scanner.readBool());
+                    break;
+                case 'n':
+                    scanner.readNull();
+                    handler.null();
+                    break;
+                default:
+                    std::visit([this](const auto value) { handler.number(value); }, scanner.readNumber());
+                    break;
+            }
+            if (scanner.pos != raw.size()) {
+                throw std::runtime_error("Invalid Json Format, malformed literal");
+            }
+            afterValue();
+        }
+
+        size_t scanScalar(const StringView chunk, const size_t tokenStart) {
+            size_t i = tokenStart;
+            while (i < chunk.size() && isScalarChar(chunk[i])) {
+                i++;
+            }
+            if (i == chunk.size()) {
+                // The scalar may go on in the next chunk.
+                token.append(chunk.data() + tokenStart, i - tokenStart);
+                return i;
+            }
+            emitScalar(completeToken(chunk, tokenStart, i));
+            token.clear();
+            return i;
+        }
+
+    public:
+        explicit SaxPushParser(Handler &handler) : handler(handler) {}
+
+        void feed(const StringView chunk) {
+            size_t i = 0;
+            while (i < chunk.size()) {
+                if (state == State::InString) {
+                    i = scanString(chunk, i);
+                    continue;
+                }
+                if (state == State::InScalar) {
+                    i = scanScalar(chunk, i);
+                    continue;
+                }
+
+                const char c = chunk[i];
+                if (isWhitespace(c)) {
+                    i++;
+                    continue;
+                }
+
+                switch (state) {
+                    case State::ExpectValue:
+                        beginValue(chunk, i);
+                        break;
+                    case State::ExpectValueOrArrayEnd:
+                        if (c == ']') {
+                            closeContainer('[');
+                            i++;
+                        } else {
+                            beginValue(chunk, i);
+                        }
+                        break;
+                    case State::ExpectKeyOrObjectEnd:
+                    case State::ExpectKey:
+                        if (c == '}' && state == State::ExpectKeyOrObjectEnd) {
+                            closeContainer('{');
+                            i++;
+                        } else if (c == '"') {
+                            stringIsKey = true;
+                            state = State::InString;
+                        } else {
+                            throw std::runtime_error("Invalid Json Format, object keys must be strings");
+                        }
+                        break;
+                    case State::ExpectColon:
+                        if (c != ':') {
+                            throw std::runtime_error("Invalid Json Format, expected ':' after an object key");
+                        }
+                        state = State::ExpectValue;
+                        i++;
+                        break;
+                    case State::ExpectCommaOrEnd:
+                        if (c == ',') {
+                            state = containers.back() == '{' ? State::ExpectKey : State::ExpectValue;
+                        } else if (c == '}' || c == ']') {
+                            closeContainer(c == '}' ? '{' : '[');
+                        } else {
+                            throw std::runtime_error("Invalid Json Format, expected ',' or the end of a container");
+                        }
+                        i++;
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid Json Format, trailing characters after the document");
+                }
+            }
+        }
+
+        // Ends the input. Throws when the document is incomplete.
+        void finish() {
+            if (state == State::InScalar) {
+                emitScalar(token);
+                token.clear();
+            }
+            if (state != State::Done) {
+                throw std::runtime_error("Invalid Json Format, unexpected end of input");
+            }
+        }
+    };
+
+    // Push parser that assembles a Json, the chunked counterpart of parseJson.
+    class PushParser {
+    private:
+        Builder builder;
+        SaxPushParser<Builder> parser;
+
+    public:
+        explicit PushParser(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : builder(resource, false), parser(builder) {}
+
+        PushParser(const PushParser &other) = delete;
+
+        PushParser &operator=(const PushParser &other) = delete;
+
+        void feed(const StringView chunk) {
+            parser.feed(chunk);
+        }
+
+        [[nodiscard]] Json finish() {
+            parser.finish();
+            return std::move(builder.root);
+        }
+    };
+}
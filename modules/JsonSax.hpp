@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include "JsonScanner.hpp"
+
+namespace Json {
+    // Receiver of parse events. Strings and keys are views that only live until the call returns,
+    // numbers arrive as whichever of Number, Integer and Unsigned the token holds. A handler may also have
+    // source(StringView), it then gets the raw text of every value right after the value's last event.
+    template<class Handler>
+    concept SaxHandler = requires(Handler &handler, const StringView text) {
+        handler.startObject();
+        handler.endObject();
+        handler.startArray();
+        handler.endArray();
+        handler.key(text);
+        handler.string(text);
+        handler.number(Number{});
+        handler.number(Integer{});
+        handler.number(Unsigned{});
+        handler.boolean(Bool{});
+        handler.null();
+    };
+
+    template<SaxHandler Handler>
+    struct SaxReader : Scanner {
+        Handler &handler;
+
+        // Escaped strings are decoded here, every other string is a view of the input.
+        std::string scratch;
+
+        SaxReader(const std::string_view &sv, const StructuralIndex *index, Handler &handler)
+                : Scanner(sv, index), handler(handler) {}
+
+        StringView readText() {
+            return insitu ? readStringView() : readStringBorrowed(scratch);
+        }
+
+        void readValue() {
+            if constexpr (requires { handler.source(StringView{}); }) {
+                const Signal type = nextType();
+                const size_t start = pos;
+                readValue(type);
+                handler.source(sv.substr(start, pos - start));
+            } else {
+                readValue(nextType());
+            }
+        }
+
+        void readValue(const Signal type) {
+            switch (type) {
+                case Signal::OBJECT:
+                    pos++;
+                    handler.startObject();
+                    for (Signal next; (next = nextType()) != Signal::ObjectEnd;) {
+                        if (next != Signal::STRING) {
+                            throw std::runtime_error("Invalid Json Format, object keys must be strings");
+                        }
+                        handler.key(readText());
+                        readValue();
+                    }
+                    pos++;
+                    handler.endObject();
+                    return;
+                case Signal::ARRAY:
+                    pos++;
+                    handler.startArray();
+                    while (nextType() != Signal::ArrayEnd) {
+                        readValue();
+                    }
+                    pos++;
+                    handler.endArray();
+                    return;
+                case Signal::STRING:
+                    handler.string(readText());
+                    return;
+                case Signal::NUMBER:
+                    std::visit([this](const auto value) { handler.number(value); }, readNumber());
+                    return;
+                case Signal::BOOL:
+                    handler.boolean(readBool());
+                    return;
+                case Signal::NULLPTR:
+                    readNull();
+                    handler.null();
+                    return;
+                default:
+                    throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+            }
+        }
+    };
+
+    // Streams the events of the first value in str to handler without building anything.
+    template<SaxHandler Handler>
+    void parseJsonSax(const StringView str, Handler &handler) {
+        withStructuralIndex(str, [&](const StructuralIndex *index) {
+            SaxReader<Handler>(str, index, handler).readValue();
+        });
+    }
+}
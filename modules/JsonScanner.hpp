@@ -0,0 +1,438 @@
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <variant>
+#include "ByteSearch.hpp"
+#include "JsonForwardHeader.hpp"
+#include "StructuralIndex.hpp"
+
+namespace Json {
+    // Tokenizer shared by everything that reads Json text. It only finds and decodes tokens,
+    // what is built from them is up to the code on top of it.
+    struct Scanner {
+        const std::string_view sv;
+        size_t pos = 0;
+
+        // Optional token positions from the stage-1 pass, nextType() jumps along them instead of walking bytes.
+        const StructuralIndex *index = nullptr;
+        size_t cursor = 0;
+
+        // Writable alias of sv when parsing insitu, escaped strings are decoded into it.
+        char *insitu = nullptr;
+
+        explicit Scanner(const std::string_view &sv, const StructuralIndex *index = nullptr) : sv(sv), index(index) {}
+
+        char now() {
+            return sv[pos];
+        }
+
+        enum class Signal {
+            STRING,
+            OBJECT,
+            ARRAY,
+            NUMBER,
+            BOOL,
+            NULLPTR,
+            ObjectEnd,
+            ArrayEnd
+        };
+
+        void jumpToNextToken() {
+            const auto &positions = index->positions();
+            while (cursor < positions.size() && positions[cursor] < pos) {
+                cursor++;
+            }
+            pos = cursor < positions.size() ? positions[cursor] : sv.size();
+        }
+
+        Signal nextType() {
+            if (index) {
+                jumpToNextToken();
+            }
+            while (pos < sv.size()) {
+                switch (now()) {
+                    case '"':
+                        return Signal::STRING;
+                    case '{':
+                        return Signal::OBJECT;
+                    case '[':
+                        return Signal::ARRAY;
+                    case 't':
+                    case 'f':
+                        return Signal::BOOL;
+                    case 'n':
+                        return Signal::NULLPTR;
+                    case '-':
+                    case '+':
+                    case '.':
+                    case '0':
+                    case '1':
+                    case '2':
+                    case '3':
+                    case '4':
+                    case '5':
+                    case '6':
+                    case '7':
+                    case '8':
+                    case '9':
+                        return Signal::NUMBER;
+                    case '}':
+                        return Signal::ObjectEnd;
+                    case ']':
+                        return Signal::ArrayEnd;
+                    default:
+                        break;
+                }
+                pos++;
+            }
+            throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+        }
+
+        // Bytes that end a run of plain string text.
+        struct QuoteOrBackslash {
+            bool operator()(const char c) const {
+                return c == '"' || c == '\\';
+            }
+
+#ifdef JSON_SSE2
+            __m128i operator()(const __m128i bytes) const {
+                return _mm_or_si128(bytesEqual(bytes, '"'), bytesEqual(bytes, '\\'));
+            }
+#endif
+        };
+
+        struct QuoteOrBracket {
+            bool operator()(const char c) const {
+                return c == '"' || c == '{' || c == '}' || c == '[' || c == ']';
+            }
+
+#ifdef JSON_SSE2
+            __m128i operator()(const __m128i bytes) const {
+                const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(bracketFold));
+                return _mm_or_si128(bytesEqual(bytes, '"'),
+                                    _mm_or_si128(bytesEqual(folded, '{'), bytesEqual(folded, '}')));
+            }
+#endif
+        };
+
+        // Offset of the next quote or backslash from pos on, found in one pass so that scanning past an escape
+        // only looks at the bytes up to the next one.
+        size_t findStringSpecial() const {
+            const size_t special = findFirst(sv, pos, QuoteOrBackslash{});
+            if (special == sv.size()) {
+                throw std::runtime_error("Invalid Json Format, unterminated string");
+            }
+            return special;
+        }
+
+        // Offset of the next quote or bracket from pos on, sv.size() when there is none.
+        size_t findQuoteOrBracket() const {
+            return findFirst(sv, pos, QuoteOrBracket{});
+        }
+
+        // Moves pos past the string starting at pos without decoding it.
+        void skipString() {
+            pos++;
+            while (true) {
+                const size_t special = findStringSpecial();
+                if (sv[special] == '"') {
+                    pos = special + 1;
+                    return;
+                }
+                // Whatever follows the backslash is part of the escape.
+                pos = special + 2;
+                if (pos >= sv.size()) {
+                    throw std::runtime_error("Invalid Json Format, unterminated string");
+                }
+            }
+        }
+
+        // Moves pos past the value starting at pos without decoding it. Containers are skipped by matching
+        // brackets, so nothing inside them is checked.
+        void skipValue() {
+            switch (now()) {
+                case '"':
+                    skipString();
+                    return;
+                case '{':
+                case '[': {
+                    size_t depth = 0;
+                    while (true) {
+                        pos = findQuoteOrBracket();
+                        if (pos == sv.size()) {
+                            throw std::runtime_error("Invalid Json Format, unterminated container");
+                        }
+                        const char c = now();
+                        if (c == '"') {
+                            skipString();
+                            continue;
+                        }
+                        pos++;
+                        if (c == '{' || c == '[') {
+                            depth++;
+                        } else if (--depth == 0) {
+                            return;
+                        }
+                    }
+                }
+                default:
+                    while (pos < sv.size()) {
+                        const char c = now();
+                        if (c == ',' || c == ':' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                            return;
+                        }
+                        pos++;
+                    }
+                    return;
+            }
+        }
+
+        uint32_t readHex4() {
+            if (pos + 4 > sv.size()) {
+                throw std::runtime_error("Invalid Json Format, truncated unicode escape");
+            }
+            uint32_t value = 0;
+            for (size_t end = pos + 4; pos < end; pos++) {
+                const char c = now();
+                value <<= 4;
+                if (c >= '0' && c <= '9') value |= c - '0';
+                else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+                else throw std::runtime_error("Invalid Json Format, bad unicode escape");
+            }
+            return value;
+        }
+
+        // Decodes the escape sequence whose backslash is at pos into utf8, returns the number of bytes written.
+        size_t readEscape(char (&utf8)[4]) {
+            pos++;
+            if (pos >= sv.size()) {
+                throw std::runtime_error("Invalid Json Format, unterminated string");
+            }
+            const char c = now();
+            pos++;
+            switch (c) {
+                case '"':
+                case '\\':
+                case '/':
+                    utf8[0] = c;
+                    return 1;
+                case 'b':
+                    utf8[0] = '\b';
+                    return 1;
+                case 'f':
+                    utf8[0] = '\f';
+                    return 1;
+                case 'n':
+                    utf8[0] = '\n';
+                    return 1;
+                case 'r':
+                    utf8[0] = '\r';
+                    return 1;
+                case 't':
+                    utf8[0] = '\t';
+                    return 1;
+                case 'u':
+                    break;
+                default:
+                    throw std::runtime_error("Invalid Json Format, unknown escape sequence");
+            }
+
+            uint32_t codePoint = readHex4();
+            if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                if (sv.substr(pos, 2) != "\\u") {
+                    throw std::runtime_error("Invalid Json Format, unpaired surrogate");
+                }
+                pos += 2;
+                const uint32_t low = readHex4();
+                if (low < 0xDC00 || low >= 0xE000) {
+                    throw std::runtime_error("Invalid Json Format, unpaired surrogate");
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            if (codePoint < 0x80) {
+                utf8[0] = static_cast<char>(codePoint);
+                return 1;
+            }
+            if (codePoint < 0x800) {
+                utf8[0] = static_cast<char>(0xC0 | codePoint >> 6);
+                utf8[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+                return 2;
+            }
+            if (codePoint < 0x10000) {
+                utf8[0] = static_cast<char>(0xE0 | codePoint >> 12);
+                utf8[1] = static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+                utf8[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+                return 3;
+            }
+            utf8[0] = static_cast<char>(0xF0 | codePoint >> 18);
+            utf8[1] = static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+            utf8[2] = static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            utf8[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            return 4;
+        }
+
+        // Appends the decoded string starting at pos to out, anything with append(const char *, size_t).
+        void readStringTo(auto &out) {
+            ++pos;
+            while (true) {
+                const size_t special = findStringSpecial();
+                out.append(sv.data() + pos, special - pos);
+                pos = special;
+                if (now() == '"') {
+                    pos++;
+                    return;
+                }
+                char utf8[4];
+                out.append(utf8, readEscape(utf8));
+            }
+        }
+
+        // The string at pos as a view of the input when it has no escapes. Otherwise it is decoded into scratch
+        // and the view is of scratch, valid until scratch is touched again.
+        StringView readStringBorrowed(std::string &scratch) {
+            const size_t start = pos + 1;
+            pos = start;
+            const size_t special = findStringSpecial();
+            if (sv[special] == '"') {
+                pos = special + 1;
+                return sv.substr(start, special - start);
+            }
+            scratch.clear();
+            pos = start - 1;
+            readStringTo(scratch);
+            return scratch;
+        }
+
+        // Insitu counterpart of readString(). A string without escapes is returned as a view of the input,
+        // otherwise it is decoded over its own escaped text, which is never shorter than the result.
+        StringView readStringView() {
+            const size_t start = ++pos;
+            size_t out = pos;
+            while (true) {
+                const size_t special = findStringSpecial();
+                if (out != pos) {
+                    std::memmove(insitu + out, insitu + pos, special - pos);
+                }
+                out += special - pos;
+                pos = special;
+                if (now() == '"') {
+                    pos++;
+                    return {sv.data() + start, out - start};
+                }
+                char utf8[4];
+                const size_t length = readEscape(utf8);
+                std::memcpy(insitu + out, utf8, length);
+                out += length;
+            }
+        }
+
+        std::variant<Number, Integer, Unsigned> readNumber() {
+            const size_t start = pos;
+            const auto digits = [this] {
+                const size_t from = pos;
+                while (pos < sv.size() && now() >= '0' && now() <= '9') {
+                    pos++;
+                }
+                return pos != from;
+            };
+
+            // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, from_chars alone would also take ".5", "01" and "1.".
+            bool isInteger = true;
+            if (pos < sv.size() && now() == '-') {
+                pos++;
+            }
+            if (pos < sv.size() && now() == '0') {
+                pos++;
+            } else if (!digits()) {
+                throw std::runtime_error("Invalid Json Format, malformed number");
+            }
+            if (pos < sv.size() && now() == '.') {
+                pos++;
+                isInteger = false;
+                if (!digits()) {
+                    throw std::runtime_error("Invalid Json Format, malformed number");
+                }
+            }
+            if (pos < sv.size() && (now() == 'e' || now() == 'E')) {
+                pos++;
+                isInteger = false;
+                if (pos < sv.size() && (now() == '+' || now() == '-')) {
+                    pos++;
+                }
+                if (!digits()) {
+                    throw std::runtime_error("Invalid Json Format, malformed number");
+                }
+            }
+            if (pos < sv.size() && ((now() >= '0' && now() <= '9') || now() == '.' || now() == '-' || now() == '+')) {
+                throw std::runtime_error("Invalid Json Format, malformed number");
+            }
+
+            const char *first = sv.data() + start;
+            const char *last = sv.data() + pos;
+            if (isInteger) {
+                if (*first == '-') {
+                    Integer value;
+                    const auto [ptr, ec] = std::from_chars(first, last, value);
+                    if (ec == std::errc{}) {
+                        return value;
+                    }
+                } else {
+                    Unsigned value;
+                    const auto [ptr, ec] = std::from_chars(first, last, value);
+                    if (ec == std::errc{}) {
+                        if (value <= static_cast<Unsigned>(std::numeric_limits<Integer>::max())) {
+                            return static_cast<Integer>(value);
+                        }
+                        return value;
+                    }
+                }
+                // Integers beyond 64 bits fall through to a double.
+            }
+
+            Number value;
+            const auto [ptr, ec] = std::from_chars(first, last, value);
+            if (ec == std::errc::result_out_of_range) {
+                throw std::runtime_error("Invalid Json Format, number out of range");
+            }
+            if (ec != std::errc{} || ptr != last) {
+                throw std::runtime_error("Invalid Json Format, malformed number");
+            }
+            return value;
+        }
+
+        Bool readBool() {
+            if (sv.substr(pos, 4) == "true") {
+                pos += 4;
+                return true;
+            } else if (sv.substr(pos, 5) == "false") {
+                pos += 5;
+                return false;
+            } else {
+                throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+            }
+        }
+
+        void readNull() {
+            if (sv.substr(pos, 4) == "null") {
+                pos += 4;
+            } else {
+                throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+            }
+        }
+    };
+
+    // Calls parse with a stage-1 index of sv, or with nullptr when sv is too long to be indexed.
+    decltype(auto) withStructuralIndex(const std::string_view sv, auto &&parse) {
+        if (sv.size() > StructuralIndex::maxInputSize) {
+            return parse(nullptr);
+        }
+        const StructuralIndex index(sv);
+        return parse(&index);
+    }
+}
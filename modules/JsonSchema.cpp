@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "JsonBuilder.hpp"
+#include "JsonSchema.hpp"
+
+namespace Json {
+    namespace {
+        [[noreturn]] void fail(const std::string &what) {
+            throw std::runtime_error("Invalid Json Schema, " + what);
+        }
+
+        double numberOf(const Json &json, const char *keyword) {
+            const DataType type = json.what();
+            if (type != DataType::NUMBER && type != DataType::INTEGER && type != DataType::UNSIGNED) {
+                fail(std::string(keyword) + " has to be a number");
+            }
+            return json.getNumber();
+        }
+
+        size_t lengthOf(const Json &json, const char *keyword) {
+            if (json.what() == DataType::INTEGER && json.get<Integer>() >= 0) {
+                return static_cast<size_t>(json.get<Integer>());
+            }
+            if (json.what() == DataType::UNSIGNED) {
+                return static_cast<size_t>(json.get<Unsigned>());
+            }
+            fail(std::string(keyword) + " has to be a non-negative integer");
+        }
+
+        // Length in code points, as JSON Schema counts it.
+        size_t codePoints(const StringView text) {
+            size_t count = 0;
+            for (const char c: text) {
+                count += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+            }
+            return count;
+        }
+    }
+
+    Schema::Schema(const Json &schema) {
+        nodes.emplace_back();
+        rootState = compile(schema);
+    }
+
+    Schema::State Schema::compile(const Json &schema) {
+        if (schema.what() == DataType::BOOL) {
+            if (schema.get<Bool>()) return ANY;
+            Node never;
+            never.types = 0;
+            nodes.push_back(never);
+            return static_cast<State>(nodes.size() - 1);
+        }
+        if (schema.what() != DataType::OBJECT) {
+            fail("a schema is an object or a bool");
+        }
+        const Object &keywords = schema.get<Object>();
+        // Nested schemas are compiled first and land in the tables before this one, so the properties of
+        // this node are gathered here and appended in one piece at the end.
+        Node node;
+        std::vector<Property> own;
+
+        if (const auto it = keywords.find("type"); it != keywords.end()) {
+            const auto typeBits = [](const Json &name) -> uint8_t {
+                if (name.what() != DataType::STRING) fail("type names have to be strings");
+                const StringView type = name.getStringView();
+                if (type == "null") return TYPE_NULL;
+                if (type == "boolean") return TYPE_BOOL;
+                if (type == "object") return TYPE_OBJECT;
+                if (type == "array") return TYPE_ARRAY;
+                if (type == "number") return TYPE_NUMBER | TYPE_INTEGER;
+                if (type == "integer") return TYPE_INTEGER;
+                if (type == "string") return TYPE_STRING;
+                fail("unknown type \"" + std::string(type) + "\"");
+            };
+            if (it->second.what() == DataType::ARRAY) {
+                node.types = 0;
+                for (const Json &name: it->second.get<Array>()) {
+                    node.types |= typeBits(name);
+                }
+            } else {
+                node.types = typeBits(it->second);
+            }
+        }
+        if (const auto it = keywords.find("properties"); it != keywords.end()) {
+            if (it->second.what() != DataType::OBJECT) fail("properties has to be an object");
+            for (const auto &[K, V]: it->second.get<Object>()) {
+                own.push_back({std::string(K.view()), compile(V), NOT_REQUIRED});
+            }
+        }
+        if (const auto it = keywords.find("required"); it != keywords.end()) {
+            if (it->second.what() != DataType::ARRAY) fail("required has to be an array");
+            for (const Json &name: it->second.get<Array>()) {
+                if (name.what() != DataType::STRING) fail("required names have to be strings");
+                const StringView key = name.getStringView();
+                auto property = std::ranges::find(own, key, &Property::name);
+                if (property == own.end()) {
+                    own.push_back({std::string(key), ANY, NOT_REQUIRED});
+                    property = own.end() - 1;
+                }
+                if (property->required == NOT_REQUIRED) {
+                    property->required = node.requiredCount++;
+                }
+            }
+        }
+        if (const auto it = keywords.find("additionalProperties"); it != keywords.end()) {
+            const bool rejected = it->second.what() == DataType::BOOL && !it->second.get<Bool>();
+            node.additional = rejected ? REJECT : compile(it->second);
+        }
+        if (const auto it = keywords.find("items"); it != keywords.end()) {
+            node.items = compile(it->second);
+        }
+        if (const auto it = keywords.find("minimum"); it != keywords.end()) {
+            node.minimum = numberOf(it->second, "minimum");
+        }
+        if (const auto it = keywords.find("maximum"); it != keywords.end()) {
+            node.maximum = numberOf(it->second, "maximum");
+        }
+        if (const auto it = keywords.find("exclusiveMinimum"); it != keywords.end()) {
+            const double bound = numberOf(it->second, "exclusiveMinimum");
+            if (bound >= node.minimum) {
+                node.minimum = bound;
+                node.exclusiveMinimum = true;
+            }
+        }
+        if (const auto it = keywords.find("exclusiveMaximum"); it != keywords.end()) {
+            const double bound = numberOf(it->second, "exclusiveMaximum");
+            if (bound <= node.maximum) {
+                node.maximum = bound;
+                node.exclusiveMaximum = true;
+            }
+        }
+        if (const auto it = keywords.find("minLength"); it != keywords.end()) {
+            node.minLength = lengthOf(it->second, "minLength");
+        }
+        if (const auto it = keywords.find("maxLength"); it != keywords.end()) {
+            node.maxLength = lengthOf(it->second, "maxLength");
+        }
+        if (const auto it = keywords.find("enum"); it != keywords.end()) {
+            if (it->second.what() != DataType::ARRAY) fail("enum has to be an array");
+            node.firstEnum = static_cast<uint32_t>(enums.size());
+            for (const Json &value: it->second.get<Array>()) {
+                if (value.what() == DataType::OBJECT || value.what() == DataType::ARRAY) {
+                    fail("enum values have to be scalars");
+                }
+                // Strings are copied, the schema may only view them.
+                enums.push_back(value.what() == DataType::STRING ? Json{String(value.getStringView())} : value);
+            }
+            node.enumCount = static_cast<uint32_t>(enums.size()) - node.firstEnum;
+        }
+
+        std::ranges::sort(own, {}, &Property::name);
+        node.firstProperty = static_cast<uint32_t>(properties.size());
+        node.propertyCount = static_cast<uint32_t>(own.size());
+        std::ranges::move(own, std::back_inserter(properties));
+        nodes.push_back(node);
+        return static_cast<State>(nodes.size() - 1);
+    }
+
+    const char *Schema::checkEnum(const Node &node, const Json &value) const {
+        if (node.enumCount == 0) return nullptr;
+        for (uint32_t i = node.firstEnum; i < node.firstEnum + node.enumCount; i++) {
+            if (enums[i] == value) return nullptr;
+        }
+        return "value is not one of the enum values";
+    }
+
+    const char *Schema::checkObject(const State state) const {
+        const Node &node = nodes[state];
+        if (!(node.types & TYPE_OBJECT)) return "object not allowed";
+        if (node.enumCount != 0) return "value is not one of the enum values";
+        return nullptr;
+    }
+
+    const char *Schema::checkArray(const State state) const {
+        const Node &node = nodes[state];
+        if (!(node.types & TYPE_ARRAY)) return "array not allowed";
+        if (node.enumCount != 0) return "value is not one of the enum values";
+        return nullptr;
+    }
+
+    const char *Schema::checkString(const State state, const StringView text) const {
+        const Node &node = nodes[state];
+        if (!(node.types & TYPE_STRING)) return "string not allowed";
+        if (node.minLength != 0 || node.maxLength != std::numeric_limits<size_t>::max()) {
+            const size_t length = codePoints(text);
+            if (length < node.minLength) return "string shorter than minLength";
+            if (length > node.maxLength) return "string longer than maxLength";
+        }
+        return checkEnum(node, Json{text});
+    }
+
+    const char *Schema::checkNumber(const State state, const double value, const bool integral, const Json &json) const {
+        const Node &node = nodes[state];
+        if (!(node.types & (integral ? TYPE_INTEGER : TYPE_NUMBER))) {
+            return node.types & TYPE_INTEGER ? "integer expected" : "number not allowed";
+        }
+        if (node.exclusiveMinimum ? value <= node.minimum : value < node.minimum) return "number below minimum";
+        if (node.exclusiveMaximum ? value >= node.maximum : value > node.maximum) return "number above maximum";
+        return checkEnum(node, json);
+    }
+
+    const char *Schema::checkNumber(const State state, const Number value) const {
+        // Numbers without a fractional part count as integers.
+        return checkNumber(state, value, std::isfinite(value) && std::trunc(value) == value, Json{value});
+    }
+
+    const char *Schema::checkNumber(const State state, const Integer value) const {
+        return checkNumber(state, static_cast<double>(value), true, Json{value});
+    }
+
+    const char *Schema::checkNumber(const State state, const Unsigned value) const {
+        return checkNumber(state, static_cast<double>(value), true, Json{value});
+    }
+
+    const char *Schema::checkBool(const State state, const Bool value) const {
+        const Node &node = nodes[state];
+        if (!(node.types & TYPE_BOOL)) return "bool not allowed";
+        return checkEnum(node, Json{value});
+    }
+
+    const char *Schema::checkNull(const State state) const {
+        const Node &node = nodes[state];
+        if (!(node.types & TYPE_NULL)) return "null not allowed";
+        return checkEnum(node, Json{});
+    }
+
+    Schema::State Schema::memberState(const State state, const StringView key, std::vector<uint64_t> &seen) const {
+        const Node &node = nodes[state];
+        const auto first = properties.begin() + node.firstProperty;
+        const auto last = first + node.propertyCount;
+        const auto property = std::lower_bound(first, last, key, [](const Property &p, const StringView k) {
+            return p.name < k;
+        });
+        if (property == last || property->name != key) {
+            return node.additional;
+        }
+        if (property->required != NOT_REQUIRED) {
+            seen[property->required / 64] |= uint64_t{1} << (property->required % 64);
+        }
+        return property->state;
+    }
+
+    const std::string *Schema::missingMember(const State state, const std::vector<uint64_t> &seen) const {
+        const Node &node = nodes[state];
+        if (node.requiredCount == 0) return nullptr;
+        for (uint32_t i = node.firstProperty; i < node.firstProperty + node.propertyCount; i++) {
+            const uint32_t bit = properties[i].required;
+            if (bit != NOT_REQUIRED && !(seen[bit / 64] >> (bit % 64) & 1)) {
+                return &properties[i].name;
+            }
+        }
+        return nullptr;
+    }
+
+    Json parseJson(const std::string &str, const Schema &schema) {
+        Builder builder(std::pmr::get_default_resource(), false);
+        SchemaValidator<Builder> validator(schema, builder);
+        parseJsonSax(str, validator);
+        return std::move(builder.root);
+    }
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Json.hpp"
+#include "JsonSax.hpp"
+
+namespace Json {
+    // A JSON Schema subset compiled into a table of states, one per (sub)schema, that values are checked
+    // against while they are parsed. Supported keywords: type, properties, required, additionalProperties,
+    // items, minimum, maximum, exclusiveMinimum, exclusiveMaximum (as numbers), minLength, maxLength and enum
+    // with scalar values. Other keywords are ignored. Throws std::runtime_error for schemas it cannot compile.
+    class Schema {
+    public:
+        using State = uint32_t;
+
+        // The empty schema, everything is valid.
+        static constexpr State ANY = 0;
+
+        // Members not allowed by additionalProperties false.
+        static constexpr State REJECT = std::numeric_limits<State>::max();
+
+    private:
+        static constexpr uint8_t TYPE_NULL = 1;
+        static constexpr uint8_t TYPE_BOOL = 2;
+        static constexpr uint8_t TYPE_OBJECT = 4;
+        static constexpr uint8_t TYPE_ARRAY = 8;
+        // "number" allows integers as well, so it sets both bits.
+        static constexpr uint8_t TYPE_NUMBER = 16;
+        static constexpr uint8_t TYPE_INTEGER = 32;
+        static constexpr uint8_t TYPE_STRING = 64;
+        static constexpr uint8_t TYPE_ALL = 127;
+
+        struct Property {
+            std::string name;
+            State state;
+            // Bit in the object's seen set, NOT_REQUIRED when the member is optional.
+            uint32_t required;
+        };
+
+        struct Node {
+            uint8_t types = TYPE_ALL;
+            uint32_t firstProperty = 0;
+            uint32_t propertyCount = 0;
+            uint32_t requiredCount = 0;
+            State additional = ANY;
+            State items = ANY;
+            double minimum = -std::numeric_limits<double>::infinity();
+            double maximum = std::numeric_limits<double>::infinity();
+            bool exclusiveMinimum = false;
+            bool exclusiveMaximum = false;
+            size_t minLength = 0;
+            size_t maxLength = std::numeric_limits<size_t>::max();
+            uint32_t firstEnum = 0;
+            uint32_t enumCount = 0;
+        };
+
+        static constexpr uint32_t NOT_REQUIRED = std::numeric_limits<uint32_t>::max();
+
+        std::vector<Node> nodes;
+        // Properties of every node, each node's sorted by name.
+        std::vector<Property> properties;
+        std::vector<Json> enums;
+        State rootState;
+
+        State compile(const Json &schema);
+
+        const char *checkEnum(const Node &node, const Json &value) const;
+
+        const char *checkNumber(State state, double value, bool integral, const Json &json) const;
+
+    public:
+        explicit Schema(const Json &schema);
+
+        [[nodiscard]] State root() const {
+            return rootState;
+        }
+
+        // The checks return nullptr when the value is valid in state, otherwise what is wrong with it.
+        [[nodiscard]] const char *checkObject(State state) const;
+
+        [[nodiscard]] const char *checkArray(State state) const;
+
+        [[nodiscard]] const char *checkString(State state, StringView text) const;
+
+        [[nodiscard]] const char *checkNumber(State state, Number value) const;
+
+        [[nodiscard]] const char *checkNumber(State state, Integer value) const;
+
+        [[nodiscard]] const char *checkNumber(State state, Unsigned value) const;
+
+        [[nodiscard]] const char *checkBool(State state, Bool value) const;
+
+        [[nodiscard]] const char *checkNull(State state) const;
+
+        // Words of the set an object in state uses to track its required members.
+        [[nodiscard]] size_t seenWords(State state) const {
+            return (nodes[state].requiredCount + 63) / 64;
+        }
+
+        // State of the member key of an object in state, REJECT when it is not allowed. Marks required
+        // members in seen.
+        [[nodiscard]] State memberState(State state, StringView key, std::vector<uint64_t> &seen) const;
+
+        [[nodiscard]] State itemState(const State state) const {
+            return nodes[state].items;
+        }
+
+        // A required member that is not in seen, nullptr when all of them are.
+        [[nodiscard]] const std::string *missingMember(State state, const std::vector<uint64_t> &seen) const;
+    };
+
+    // Sax handler that checks every event against a Schema before passing it on to handler, throwing
+    // std::runtime_error at the first violation. Events after it never reach handler.
+    template<SaxHandler Handler>
+    class SchemaValidator {
+    private:
+        struct Frame {
+            Schema::State state;
+            bool isObject;
+            // State of the value of the current member.
+            Schema::State member;
+            std::vector<uint64_t> seen;
+            // Where the current value is, for messages.
+            std::string key;
+            size_t index;
+        };
+
+        const Schema &schema;
+        Handler &handler;
+
+        // Frames stay allocated when containers end, so their buffers are reused.
+        std::vector<Frame> frames;
+        size_t depth = 0;
+
+        Schema::State valueState() const {
+            if (depth == 0) return schema.root();
+            const Frame &top = frames[depth - 1];
+            return top.isObject ? top.member : schema.itemState(top.state);
+        }
+
+        // JSON Pointer of the value inside the first levels containers.
+        std::string pointer(const size_t levels) const {
+            std::string out;
+            for (size_t i = 0; i < levels; i++) {
+                out += '/';
+                if (!frames[i].isObject) {
+                    out += std::to_string(frames[i].index);
+                    continue;
+                }
+                for (const char c: frames[i].key) {
+                    if (c == '~') out += "~0";
+                    else if (c == '/') out += "~1";
+                    else out += c;
+                }
+            }
+            return out;
+        }
+
+        [[noreturn]] void fail(const std::string &what, const size_t levels) const {
+            throw std::runtime_error("Json Schema violation, " + what + " at \"" + pointer(levels) + "\"");
+        }
+
+        void check(const char *error) const {
+            if (error) fail(error, depth);
+        }
+
+        void push(const Schema::State state, const bool isObject) {
+            if (depth == frames.size()) {
+                frames.emplace_back();
+            }
+            Frame &frame = frames[depth++];
+            frame.state = state;
+            frame.isObject = isObject;
+            frame.index = 0;
+            if (isObject) {
+                frame.seen.assign(schema.seenWords(state), 0);
+            }
+        }
+
+        void valueDone() {
+            if (depth != 0 && !frames[depth - 1].isObject) {
+                frames[depth - 1].index++;
+            }
+        }
+
+    public:
+        SchemaValidator(const Schema &schema, Handler &handler) : schema(schema), handler(handler) {}
+
+        void startObject() {
+            const Schema::State state = valueState();
+            check(schema.checkObject(state));
+            push(state, true);
+            handler.startObject();
+        }
+
+        void endObject() {
+            const Frame &top = frames[depth - 1];
+            if (const std::string *missing = schema.missingMember(top.state, top.seen)) {
+                fail("missing required member \"" + *missing + "\"", depth - 1);
+            }
+            depth--;
+            valueDone();
+            handler.endObject();
+        }
+
+        void startArray() {
+            const Schema::State state = valueState();
+            check(schema.checkArray(state));
+            push(state, false);
+            handler.startArray();
+        }
+
+        void endArray() {
+            depth--;
+            valueDone();
+            handler.endArray();
+        }
+
+        void key(const StringView text) {
+            Frame &top = frames[depth - 1];
+            top.key.assign(text);
+            top.member = schema.memberState(top.state, text, top.seen);
+            if (top.member == Schema::REJECT) {
+                fail("member not allowed", depth);
+            }
+            handler.key(text);
+        }
+
+        void string(const StringView text) {
+            check(schema.checkString(valueState(), text));
+            valueDone();
+            handler.string(text);
+        }
+
+        void number(const auto value) {
+            check(schema.checkNumber(valueState(), value));
+            valueDone();
+            handler.number(value);
+        }
+
+        void boolean(const Bool value) {
+            check(schema.checkBool(valueState(), value));
+            valueDone();
+            handler.boolean(value);
+        }
+
+        void null() {
+            check(schema.checkNull(valueState()));
+            valueDone();
+            handler.null();
+        }
+
+        void source(const StringView text) requires requires(Handler &inner) { inner.source(text); } {
+            handler.source(text);
+        }
+    };
+
+    // Parses str like parseJson while validating it against schema, stopping at the first violation.
+    Json parseJson(const std::string &str, const Schema &schema);
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include "JsonStream.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Json {
+    // push_back needs room for one byte, so a capacity of 0 is taken as 1.
+    SinkBuffer::SinkBuffer(Sink sink, const size_t capacity)
+            : sink(std::move(sink)), buffer(std::max<size_t>(capacity, 1)) {
+        if (!this->sink) {
+            throw std::invalid_argument("SinkBuffer needs a sink to write to");
+        }
+    }
+
+    void SinkBuffer::flush() {
+        if (used == 0) return;
+        sink(StringView(buffer.data(), used));
+        used = 0;
+    }
+
+    void serialize(const Json &json, std::ostream &out, const Format format) {
+        serialize(json, [&out](const StringView text) {
+            if (!out.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+                throw std::runtime_error("Could not write to the output stream");
+            }
+        }, format);
+    }
+
+    void serialize(const Json &json, const int fd, const Format format) {
+        serialize(json, [fd](StringView text) {
+            while (!text.empty()) {
+#ifdef _WIN32
+                const auto written = _write(fd, text.data(), static_cast<unsigned>(std::min<size_t>(text.size(), INT_MAX)));
+#else
+                const auto written = write(fd, text.data(), text.size());
+#endif
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error("Could not write to file descriptor " + std::to_string(fd));
+                }
+                text.remove_prefix(static_cast<size_t>(written));
+            }
+        }, format);
+    }
+
+    void serialize(const Json &json, const SinkBuffer::Sink &sink, const Format format) {
+        BasicWriter<SinkBuffer> writer(SinkBuffer(sink), format);
+        writer.write(json);
+        writer.output().flush();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+#include "JsonWriter.hpp"
+
+namespace Json {
+    // Writer output that collects bytes in a fixed buffer and hands them to sink whenever it fills up,
+    // so serializing never holds more than capacity bytes of text at once.
+    class SinkBuffer {
+    public:
+        using Sink = std::function<void(StringView)>;
+
+        constexpr static size_t defaultCapacity = 64 * 1024;
+
+        // Throws std::invalid_argument for an empty sink.
+        explicit SinkBuffer(Sink sink, size_t capacity = defaultCapacity);
+
+        void append(const char *data, const size_t length) {
+            if (length > buffer.size() - used) {
+                flush();
+                // Anything that does not fit an empty buffer goes straight through.
+                if (length >= buffer.size()) {
+                    sink(StringView(data, length));
+                    return;
+                }
+            }
+            std::copy_n(data, length, buffer.data() + used);
+            used += length;
+        }
+
+        void push_back(const char c) {
+            if (used == buffer.size()) flush();
+            buffer[used++] = c;
+        }
+
+        // Passes the buffered bytes on to the sink. Has to be called once writing is done.
+        void flush();
+
+    private:
+        Sink sink;
+        std::vector<char> buffer;
+        size_t used = 0;
+    };
+
+    // Serializes json straight into out through a SinkBuffer, without building the whole text first.
+    void serialize(const Json &json, std::ostream &out, Format format = Format::PRETTY);
+
+    // Same, writing to an open file descriptor. Throws when a write fails.
+    void serialize(const Json &json, int fd, Format format = Format::PRETTY);
+
+    // Same, handing every filled buffer to sink.
+    void serialize(const Json &json, const SinkBuffer::Sink &sink, Format format = Format::PRETTY);
+}
@@ -0,0 +1,107 @@
+#include "JsonTape.hpp"
+#include "JsonScanner.hpp"
+
+namespace Json {
+    struct TapeBuilder : Scanner {
+        TapeDocument doc;
+
+        using Scanner::Scanner;
+
+        void push(const TapeTag tag, const uint64_t payload = 0) {
+            doc.tape.push_back(static_cast<uint64_t>(tag) << 56 | payload);
+        }
+
+        void appendString() {
+            const size_t offset = doc.strings.size();
+            doc.strings.append(sizeof(uint32_t), '\0');
+            readStringTo(doc.strings);
+            if (doc.strings.size() - offset - sizeof(uint32_t) > std::numeric_limits<uint32_t>::max()) {
+                throw std::runtime_error("Invalid Json Format, string too long for a tape");
+            }
+            const auto length = static_cast<uint32_t>(doc.strings.size() - offset - sizeof(uint32_t));
+            std::memcpy(doc.strings.data() + offset, &length, sizeof length);
+            push(TapeTag::STRING, offset);
+        }
+
+        void appendNumber() {
+            std::visit([this](const auto value) {
+                using T = std::remove_const_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, Integer>) push(TapeTag::INTEGER);
+                else if constexpr (std::is_same_v<T, Unsigned>) push(TapeTag::UNSIGNED);
+                else push(TapeTag::NUMBER);
+                doc.tape.push_back(std::bit_cast<uint64_t>(value));
+            }, readNumber());
+        }
+
+        // Writes the start word once the children are known, it points just past the end word.
+        void closeContainer(const size_t start, const TapeTag startTag, const TapeTag endTag, const uint64_t count) {
+            push(endTag, start);
+            if (doc.tape.size() > std::numeric_limits<uint32_t>::max()) {
+                throw std::runtime_error("Invalid Json Format, document too large for a tape");
+            }
+            const uint64_t saturated = count < TapeDocument::countLimit ? count : TapeDocument::countLimit;
+            doc.tape[start] = static_cast<uint64_t>(startTag) << 56 | saturated << 32 | doc.tape.size();
+        }
+
+        void appendValue() {
+            switch (nextType()) {
+                case Signal::OBJECT: {
+                    const size_t start = doc.tape.size();
+                    push(TapeTag::OBJECT_START);
+                    pos++;
+                    uint64_t count = 0;
+                    for (Signal next; (next = nextType()) != Signal::ObjectEnd;) {
+                        if (next != Signal::STRING) {
+                            throw std::runtime_error("Invalid Json Format, object keys must be strings");
+                        }
+                        appendString();
+                        appendValue();
+                        count++;
+                    }
+                    pos++;
+                    closeContainer(start, TapeTag::OBJECT_START, TapeTag::OBJECT_END, count);
+                    break;
+                }
+                case Signal::ARRAY: {
+                    const size_t start = doc.tape.size();
+                    push(TapeTag::ARRAY_START);
+                    pos++;
+                    uint64_t count = 0;
+                    while (nextType() != Signal::ArrayEnd) {
+                        appendValue();
+                        count++;
+                    }
+                    pos++;
+                    closeContainer(start, TapeTag::ARRAY_START, TapeTag::ARRAY_END, count);
+                    break;
+                }
+                case Signal::STRING:
+                    appendString();
+                    break;
+                case Signal::NUMBER:
+                    appendNumber();
+                    break;
+                case Signal::BOOL:
+                    push(readBool() ? TapeTag::TRUE_VALUE : TapeTag::FALSE_VALUE);
+                    break;
+                case Signal::NULLPTR:
+                    readNull();
+                    push(TapeTag::NULLPTR);
+                    break;
+                default:
+                    throw std::runtime_error("Invalid Json Format, cannot deduce the type of the token");
+            }
+        }
+    };
+
+    TapeDocument parseJsonTape(const StringView str) {
+        return withStructuralIndex(str, [&](const StructuralIndex *index) {
+            TapeBuilder builder(str, index);
+            // A word per token is the usual upper bound, the strings rarely exceed the input.
+            builder.doc.tape.reserve(index ? index->positions().size() + 1 : str.size() / 8);
+            builder.doc.strings.reserve(str.size() / 2);
+            builder.appendValue();
+            return std::move(builder.doc);
+        });
+    }
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "JsonForwardHeader.hpp"
+
+namespace Json {
+    // The top byte of every tape word.
+    enum class TapeTag : uint8_t {
+        STRING = '"',
+        OBJECT_START = '{',
+        OBJECT_END = '}',
+        ARRAY_START = '[',
+        ARRAY_END = ']',
+        NUMBER = 'd',
+        INTEGER = 'l',
+        UNSIGNED = 'u',
+        TRUE_VALUE = 't',
+        FALSE_VALUE = 'f',
+        NULLPTR = 'n'
+    };
+
+    class TapeView;
+
+    // A parsed document laid out as one array of tagged 64 bit words in document order, plus one buffer
+    // holding every string. Each word carries its tag in the top byte and a 56 bit payload:
+    //  - container starts hold the index just past their end word in the low 32 bits and the number of
+    //    children, saturated at countLimit, above that. Container ends hold the index of their start.
+    //  - strings hold the offset of a 32 bit length followed by the bytes in the string buffer.
+    //  - numbers are followed by one word with their raw bits.
+    // Parsing throws for documents whose tape or strings do not fit these 32 bit fields.
+    class TapeDocument {
+    public:
+        constexpr static uint64_t payloadMask = (uint64_t{1} << 56) - 1;
+        constexpr static uint64_t countLimit = (uint64_t{1} << 24) - 1;
+
+        std::vector<uint64_t> tape;
+        std::string strings;
+
+        [[nodiscard]] TapeTag tagAt(const size_t index) const {
+            return static_cast<TapeTag>(tape[index] >> 56);
+        }
+
+        [[nodiscard]] uint64_t payloadAt(const size_t index) const {
+            return tape[index] & payloadMask;
+        }
+
+        [[nodiscard]] StringView stringAt(const size_t offset) const {
+            uint32_t length;
+            std::memcpy(&length, strings.data() + offset, sizeof length);
+            return {strings.data() + offset + sizeof length, length};
+        }
+
+        [[nodiscard]] TapeView root() const;
+    };
+
+    class TapeArray;
+    class TapeObject;
+
+    // A position on a TapeDocument, the read-only counterpart of Json. The document has to outlive the view.
+    class TapeView {
+    private:
+        const TapeDocument *doc;
+        size_t index;
+
+        [[nodiscard]] TapeTag tag() const {
+            return doc->tagAt(index);
+        }
+
+        template<class T>
+        [[nodiscard]] T raw() const {
+            return std::bit_cast<T>(doc->tape[index + 1]);
+        }
+
+    public:
+        TapeView(const TapeDocument &doc, const size_t index) : doc(&doc), index(index) {}
+
+        [[nodiscard]] const TapeDocument &document() const {
+            return *doc;
+        }
+
+        [[nodiscard]] size_t position() const {
+            return index;
+        }
+
+        // Index of the word after this value, containers are skipped in one step.
+        [[nodiscard]] size_t next() const {
+            switch (tag()) {
+                case TapeTag::OBJECT_START:
+                case TapeTag::ARRAY_START:
+                    return static_cast<uint32_t>(doc->payloadAt(index));
+                case TapeTag::NUMBER:
+                case TapeTag::INTEGER:
+                case TapeTag::UNSIGNED:
+                    return index + 2;
+                default:
+                    return index + 1;
+            }
+        }
+
+        [[nodiscard]] DataType what() const {
+            switch (tag()) {
+                case TapeTag::STRING:
+                    return DataType::STRING;
+                case TapeTag::OBJECT_START:
+                    return DataType::OBJECT;
+                case TapeTag::ARRAY_START:
+                    return DataType::ARRAY;
+                case TapeTag::NUMBER:
+                    return DataType::NUMBER;
+                case TapeTag::INTEGER:
+                    return DataType::INTEGER;
+                case TapeTag::UNSIGNED:
+                    return DataType::UNSIGNED;
+                case TapeTag::TRUE_VALUE:
+                case TapeTag::FALSE_VALUE:
+                    return DataType::BOOL;
+                case TapeTag::NULLPTR:
+                    return DataType::NULLPTR;
+                default:
+                    throw std::runtime_error("Invalid tape, a value cannot start with a container end");
+            }
+        }
+
+        // Same alternatives as Json::get, strings come back as StringView and containers as
+        // TapeObject / TapeArray. A mismatching type throws std::bad_variant_access like Json::get does.
+        template<class T>
+        [[nodiscard]] auto get() const;
+
+        decltype(auto) visit(auto &&visitor) const;
+    };
+
+    class TapeArray {
+    private:
+        TapeView start;
+
+    public:
+        explicit TapeArray(const TapeView start) : start(start) {}
+
+        class iterator {
+        private:
+            TapeView current;
+
+        public:
+            explicit iterator(const TapeView current) : current(current) {}
+
+            TapeView operator*() const {
+                return current;
+            }
+
+            iterator &operator++() {
+                current = TapeView(current.document(), current.next());
+                return *this;
+            }
+
+            bool operator==(const iterator &other) const {
+                return current.position() == other.current.position();
+            }
+        };
+
+        [[nodiscard]] iterator begin() const {
+            return iterator(TapeView(start.document(), start.position() + 1));
+        }
+
+        [[nodiscard]] iterator end() const {
+            return iterator(TapeView(start.document(), start.next() - 1));
+        }
+
+        [[nodiscard]] size_t size() const {
+            const uint64_t count = start.document().payloadAt(start.position()) >> 32;
+            if (count < TapeDocument::countLimit) {
+                return count;
+            }
+            size_t n = 0;
+            for (iterator it = begin(); it != end(); ++it) n++;
+            return n;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return begin() == end();
+        }
+
+        // Walks the elements before i, prefer iterating when visiting all of them.
+        [[nodiscard]] TapeView operator[](size_t i) const {
+            iterator it = begin();
+            while (i--) ++it;
+            return *it;
+        }
+    };
+
+    class TapeObject {
+    private:
+        TapeView start;
+
+    public:
+        explicit TapeObject(const TapeView start) : start(start) {}
+
+        class iterator {
+        private:
+            TapeView key;
+
+        public:
+            explicit iterator(const TapeView key) : key(key) {}
+
+            std::pair<StringView, TapeView> operator*() const {
+                const TapeDocument &doc = key.document();
+                return {doc.stringAt(doc.payloadAt(key.position())), TapeView(doc, key.position() + 1)};
+            }
+
+            iterator &operator++() {
+                key = TapeView(key.document(), TapeView(key.document(), key.position() + 1).next());
+                return *this;
+            }
+
+            bool operator==(const iterator &other) const {
+                return key.position() == other.key.position();
+            }
+        };
+
+        [[nodiscard]] iterator begin() const {
+            return iterator(TapeView(start.document(), start.position() + 1));
+        }
+
+        [[nodiscard]] iterator end() const {
+            return iterator(TapeView(start.document(), start.next() - 1));
+        }
+
+        [[nodiscard]] size_t size() const {
+            const uint64_t count = start.document().payloadAt(start.position()) >> 32;
+            if (count < TapeDocument::countLimit) {
+                return count;
+            }
+            size_t n = 0;
+            for (iterator it = begin(); it != end(); ++it) n++;
+            return n;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return begin() == end();
+        }
+
+        // Linear scan over the keys, the tape keeps them in document order.
+        [[nodiscard]] bool contains(const StringView key) const {
+            for (auto &&[K, V]: *this) {
+                if (K == key) return true;
+            }
+            return false;
+        }
+
+        [[nodiscard]] TapeView at(const StringView key) const {
+            for (auto &&[K, V]: *this) {
+                if (K == key) return V;
+            }
+            throw std::out_of_range("TapeObject::at, no such key");
+        }
+    };
+
+    template<class T>
+    auto TapeView::get() const {
+        const auto expect = [this](const bool matches) {
+            if (!matches) throw std::bad_variant_access();
+        };
+
+        if constexpr (std::is_same_v<T, String> || std::is_same_v<T, StringView>) {
+            expect(tag() == TapeTag::STRING);
+            return doc->stringAt(doc->payloadAt(index));
+        } else if constexpr (std::is_same_v<T, Object>) {
+            expect(tag() == TapeTag::OBJECT_START);
+            return TapeObject(*this);
+        } else if constexpr (std::is_same_v<T, Array>) {
+            expect(tag() == TapeTag::ARRAY_START);
+            return TapeArray(*this);
+        } else if constexpr (std::is_same_v<T, Number>) {
+            expect(tag() == TapeTag::NUMBER);
+            return raw<Number>();
+        } else if constexpr (std::is_same_v<T, Integer>) {
+            expect(tag() == TapeTag::INTEGER);
+            return raw<Integer>();
+        } else if constexpr (std::is_same_v<T, Unsigned>) {
+            expect(tag() == TapeTag::UNSIGNED);
+            return raw<Unsigned>();
+        } else if constexpr (std::is_same_v<T, Bool>) {
+            expect(tag() == TapeTag::TRUE_VALUE || tag() == TapeTag::FALSE_VALUE);
+            return tag() == TapeTag::TRUE_VALUE;
+        } else {
+            static_assert(std::is_same_v<T, NullPtr>, "TapeView::get, not a Json alternative");
+            expect(tag() == TapeTag::NULLPTR);
+            return nullptr;
+        }
+    }
+
+    decltype(auto) TapeView::visit(auto &&visitor) const {
+        switch (what()) {
+            case DataType::STRING:
+                return visitor(get<StringView>());
+            case DataType::OBJECT:
+                return visitor(get<Object>());
+            case DataType::ARRAY:
+                return visitor(get<Array>());
+            case DataType::NUMBER:
+                return visitor(get<Number>());
+            case DataType::INTEGER:
+                return visitor(get<Integer>());
+            case DataType::UNSIGNED:
+                return visitor(get<Unsigned>());
+            case DataType::BOOL:
+                return visitor(get<Bool>());
+            default:
+                return visitor(get<NullPtr>());
+        }
+    }
+
+    inline TapeView TapeDocument::root() const {
+        return {*this, 0};
+    }
+
+    TapeDocument parseJsonTape(StringView str);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <string>
+#include <utility>
+#include <vector>
+#include "CompactJson.hpp"
+#include "Json.hpp"
+#include "SharedJson.hpp"
+
+namespace Json {
+    // Output that only counts bytes, a writer over it measures the exact serialized size.
+    struct SizeCounter {
+        size_t size = 0;
+
+        void append(const char *, const size_t length) {
+            size += length;
+        }
+
+        void push_back(const char) {
+            size++;
+        }
+    };
+
+    // Serializes Json by appending to Output, a std::string or anything else with
+    // append(const char *, size_t) and push_back(char). Used as the visitor of Json::visit.
+    template<class Output>
+    class BasicWriter {
+    public:
+        explicit BasicWriter(const Format format = Format::PRETTY, const MemberOrder order = MemberOrder::SORTED)
+            requires std::default_initializable<Output>
+                : format(format), order(order) {}
+
+        BasicWriter(Output out, const Format format, const MemberOrder order = MemberOrder::SORTED)
+                : out(std::move(out)), format(format), order(order) {}
+
+        BasicWriter &write(const Json &json) {
+            if (unchanged) {
+                if (const StringView source = unchanged->getSource(json); !source.empty()) {
+                    append(source);
+                    return *this;
+                }
+            }
+            return json.visit(*this);
+        }
+
+        // Values of document that still have their source text are copied from it instead of being formatted.
+        void copyUnchanged(const Document &document) {
+            unchanged = &document;
+        }
+
+        BasicWriter &write(const CompactJson &json) {
+            return json.visit(*this);
+        }
+
+        BasicWriter &write(const SharedJson &json) {
+            return json.visit(*this);
+        }
+
+        Output &output() {
+            return out;
+        }
+
+        // Members of object in the order they are written in.
+        template<class Map>
+        std::vector<typename Map::const_iterator> members(const Map &object) const {
+            std::vector<typename Map::const_iterator> ordered;
+            ordered.reserve(object.size());
+            for (auto it = object.begin(); it != object.end(); ++it) {
+                ordered.push_back(it);
+            }
+            if (order == MemberOrder::SORTED) {
+                std::ranges::sort(ordered, {}, [](const auto it) { return it->first.view(); });
+            }
+            return ordered;
+        }
+
+        BasicWriter &operator()(const Object &object);
+
+        BasicWriter &operator()(const Array &array);
+
+        BasicWriter &operator()(const CompactObject &object);
+
+        BasicWriter &operator()(const CompactArray &array);
+
+        BasicWriter &operator()(const SharedObject &object);
+
+        BasicWriter &operator()(const SharedArray &array);
+
+        BasicWriter &operator()(StringView string);
+
+        BasicWriter &operator()(Number number);
+
+        BasicWriter &operator()(Integer number);
+
+        BasicWriter &operator()(Unsigned number);
+
+        BasicWriter &operator()(Bool value);
+
+        BasicWriter &operator()(NullPtr);
+
+    protected:
+        Output out;
+        Format format;
+        MemberOrder order;
+        size_t indent = 0;
+        const Document *unchanged = nullptr;
+
+        void append(const StringView text) {
+            out.append(text.data(), text.size());
+        }
+
+        void nextLine();
+
+        void openContainer(char open);
+
+        void closeContainer(char close);
+
+        void separator();
+
+        void colon();
+
+        void writeEscaped(StringView string);
+
+        BasicWriter &writeObject(const auto &object);
+
+        BasicWriter &writeArray(const auto &array);
+    };
+
+    using Writer = BasicWriter<std::string>;
+
+    // Exact length of json serialized in format.
+    size_t serializedSize(const Json &json, Format format);
+
+    // Same text as Writer, with large containers cut into chunks that are formatted on a pool of threads
+    // and joined in order. 0 threads means one per hardware thread.
+    std::string serializeParallel(const Json &json, Format format = Format::PRETTY, size_t threads = 0,
+                                  MemberOrder order = MemberOrder::SORTED);
+}
@@ -0,0 +1,21 @@
+#include <mutex>
+#include "KeyPool.hpp"
+
+namespace Json {
+    Key KeyPool::intern(const std::string_view text) {
+        {
+            // Almost every key of a known schema is already here, so lookups only share the lock.
+            std::shared_lock lock(mutex);
+            if (const auto it = keys.find(text); it != keys.end()) {
+                return Key::pooled(*it);
+            }
+        }
+        std::unique_lock lock(mutex);
+        return Key::pooled(*keys.insert({std::string(text), Hash{}(text)}).first);
+    }
+
+    size_t KeyPool::size() const {
+        std::shared_lock lock(mutex);
+        return keys.size();
+    }
+}
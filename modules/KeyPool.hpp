@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+
+namespace Json {
+    // Object key: either its own text or a handle to a string interned in a KeyPool. Handles to the same
+    // pooled string compare equal by pointer, everything else compares by text.
+    class Key {
+    public:
+        // A string held by a KeyPool together with its hash, which is worked out once when it is interned.
+        struct Interned {
+            std::string text;
+            size_t hash;
+        };
+
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    private:
+        std::variant<std::pmr::string, const Interned *> data;
+
+    public:
+        Key() = default;
+
+        explicit Key(const allocator_type &allocator) : data(std::in_place_index<0>, allocator) {}
+
+        Key(const std::string_view text, const allocator_type &allocator = {})
+                : data(std::in_place_index<0>, text, allocator) {}
+
+        Key(const char *text, const allocator_type &allocator = {}) : data(std::in_place_index<0>, text, allocator) {}
+
+        Key(const std::pmr::string &text, const allocator_type &allocator = {})
+                : data(std::in_place_index<0>, text, allocator) {}
+
+        Key(std::pmr::string &&text) : data(std::in_place_index<0>, std::move(text)) {}
+
+        Key(std::pmr::string &&text, const allocator_type &allocator)
+                : data(std::in_place_index<0>, std::move(text), allocator) {}
+
+        Key(const Key &other) = default;
+
+        Key(Key &&other) = default;
+
+        // Owned text is copied into allocator, handles stay handles.
+        Key(const Key &other, const allocator_type &allocator) : Key(allocator) {
+            data = other.data;
+        }
+
+        Key(Key &&other, const allocator_type &allocator) : Key(allocator) {
+            data = std::move(other.data);
+        }
+
+        Key &operator=(const Key &other) = default;
+
+        Key &operator=(Key &&other) = default;
+
+        // A handle to text owned by a KeyPool, which has to outlive the handle.
+        static Key pooled(const Interned &interned) {
+            Key key;
+            key.data = &interned;
+            return key;
+        }
+
+        [[nodiscard]] bool isInterned() const {
+            return std::holds_alternative<const Interned *>(data);
+        }
+
+        [[nodiscard]] std::string_view view() const {
+            if (const auto *interned = std::get_if<const Interned *>(&data)) {
+                return (*interned)->text;
+            }
+            return std::get<std::pmr::string>(data);
+        }
+
+        // Same as std::hash of view(), without going over the text again for pooled keys.
+        [[nodiscard]] size_t hash() const {
+            if (const auto *interned = std::get_if<const Interned *>(&data)) {
+                return (*interned)->hash;
+            }
+            return std::hash<std::string_view>{}(view());
+        }
+
+        operator std::string_view() const {
+            return view();
+        }
+
+        friend bool operator==(const Key &a, const Key &b) {
+            const auto *x = std::get_if<const Interned *>(&a.data);
+            const auto *y = std::get_if<const Interned *>(&b.data);
+            if (x && y) {
+                if (*x == *y) return true;
+                // Pooled keys of different pools can still be equal, but not with different hashes.
+                if ((*x)->hash != (*y)->hash) return false;
+            }
+            return a.view() == b.view();
+        }
+
+        friend bool operator==(const Key &a, const std::string_view b) {
+            return a.view() == b;
+        }
+    };
+
+    // Set of interned object keys, meant to be shared by every parse of documents with the same keys so each
+    // distinct key is stored once. Safe to use from several threads at once. Keys are never removed, the pool
+    // has to outlive every Json holding its keys.
+    class KeyPool {
+    private:
+        struct Hash {
+            using is_transparent = void;
+
+            size_t operator()(const std::string_view text) const {
+                return std::hash<std::string_view>{}(text);
+            }
+
+            size_t operator()(const Key::Interned &interned) const {
+                return interned.hash;
+            }
+        };
+
+        struct Equal {
+            using is_transparent = void;
+
+            static std::string_view view(const std::string_view text) {
+                return text;
+            }
+
+            static std::string_view view(const Key::Interned &interned) {
+                return interned.text;
+            }
+
+            bool operator()(const auto &a, const auto &b) const {
+                return view(a) == view(b);
+            }
+        };
+
+        // Node based, so interned strings never move.
+        std::unordered_set<Key::Interned, Hash, Equal> keys;
+        mutable std::shared_mutex mutex;
+
+    public:
+        KeyPool() = default;
+
+        KeyPool(const KeyPool &other) = delete;
+
+        KeyPool &operator=(const KeyPool &other) = delete;
+
+        Key intern(std::string_view text);
+
+        [[nodiscard]] size_t size() const;
+    };
+}
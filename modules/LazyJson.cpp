@@ -0,0 +1,177 @@
+#include <stdexcept>
+#include "JsonBuilder.hpp"
+#include "JsonSax.hpp"
+#include "LazyJson.hpp"
+
+namespace Json {
+    using Signal = Scanner::Signal;
+
+    namespace {
+        std::variant<Number, Integer, Unsigned> readNumberAt(const StringView text, const size_t pos) {
+            const char c = text[pos];
+            if (c == '"' || c == '{' || c == '[' || c == 't' || c == 'f' || c == 'n') {
+                throw std::bad_variant_access();
+            }
+            Scanner scanner(text);
+            scanner.pos = pos;
+            return scanner.readNumber();
+        }
+    }
+
+    LazyDocument::LazyDocument(std::string text) : text(std::move(text)) {}
+
+    LazyValue LazyDocument::root() {
+        Scanner scanner(text);
+        scanner.nextType();
+        return {*this, scanner.pos};
+    }
+
+    const LazyDocument::Children &LazyDocument::childrenOf(const size_t pos) {
+        if (const auto it = scanned.find(pos); it != scanned.end()) {
+            return it->second;
+        }
+
+        const bool isObject = text[pos] == '{';
+        if (!isObject && text[pos] != '[') {
+            throw std::bad_variant_access();
+        }
+
+        Children children;
+        Scanner scanner(text);
+        scanner.pos = pos + 1;
+        std::string scratch;
+        while (true) {
+            Signal next = scanner.nextType();
+            if (next == Signal::ObjectEnd || next == Signal::ArrayEnd) {
+                if ((next == Signal::ObjectEnd) != isObject) {
+                    throw std::runtime_error("Invalid Json Format, mismatched closing bracket");
+                }
+                break;
+            }
+            if (isObject) {
+                if (next != Signal::STRING) {
+                    throw std::runtime_error("Invalid Json Format, object keys must be strings");
+                }
+                StringView key = scanner.readStringBorrowed(scratch);
+                if (key.data() == scratch.data()) {
+                    key = decodedKeys.emplace_back(scratch);
+                }
+                children.keys.push_back(key);
+                next = scanner.nextType();
+                if (next == Signal::ObjectEnd || next == Signal::ArrayEnd) {
+                    throw std::runtime_error("Invalid Json Format, object member without a value");
+                }
+            }
+            children.values.push_back(scanner.pos);
+            scanner.skipValue();
+        }
+        return scanned.emplace(pos, std::move(children)).first->second;
+    }
+
+    DataType LazyValue::what() const {
+        switch (doc->text[pos]) {
+            case '"':
+                return DataType::STRING;
+            case '{':
+                return DataType::OBJECT;
+            case '[':
+                return DataType::ARRAY;
+            case 't':
+            case 'f':
+                return DataType::BOOL;
+            case 'n':
+                return DataType::NULLPTR;
+            default: {
+                constexpr DataType types[] = {DataType::NUMBER, DataType::INTEGER, DataType::UNSIGNED};
+                return types[readNumberAt(doc->text, pos).index()];
+            }
+        }
+    }
+
+    template<class T>
+    T LazyValue::get() const {
+        Scanner scanner(doc->text);
+        scanner.pos = pos;
+        const char c = doc->text[pos];
+        if constexpr (std::is_same_v<T, String>) {
+            if (c != '"') throw std::bad_variant_access();
+            String out;
+            scanner.readStringTo(out);
+            return out;
+        } else if constexpr (std::is_same_v<T, Bool>) {
+            if (c != 't' && c != 'f') throw std::bad_variant_access();
+            return scanner.readBool();
+        } else if constexpr (std::is_same_v<T, NullPtr>) {
+            if (c != 'n') throw std::bad_variant_access();
+            scanner.readNull();
+            return nullptr;
+        } else {
+            return std::get<T>(readNumberAt(doc->text, pos));
+        }
+    }
+
+    template String LazyValue::get<String>() const;
+
+    template Number LazyValue::get<Number>() const;
+
+    template Integer LazyValue::get<Integer>() const;
+
+    template Unsigned LazyValue::get<Unsigned>() const;
+
+    template Bool LazyValue::get<Bool>() const;
+
+    template NullPtr LazyValue::get<NullPtr>() const;
+
+    Number LazyValue::getNumber() const {
+        return std::visit([](const auto number) { return static_cast<Number>(number); }, readNumberAt(doc->text, pos));
+    }
+
+    size_t LazyValue::size() const {
+        return doc->childrenOf(pos).values.size();
+    }
+
+    bool LazyValue::contains(const StringView key) const {
+        for (const StringView K: doc->childrenOf(pos).keys) {
+            if (K == key) return true;
+        }
+        return false;
+    }
+
+    LazyValue LazyValue::at(const StringView key) const {
+        if (doc->text[pos] != '{') {
+            throw std::bad_variant_access();
+        }
+        const auto &children = doc->childrenOf(pos);
+        // Later duplicates win, as they do when parsing into a Json.
+        for (size_t i = children.keys.size(); i-- > 0;) {
+            if (children.keys[i] == key) return {*doc, children.values[i]};
+        }
+        throw std::out_of_range("LazyValue::at, no such key");
+    }
+
+    LazyValue LazyValue::at(const size_t index) const {
+        if (doc->text[pos] != '[') {
+            throw std::bad_variant_access();
+        }
+        const auto &children = doc->childrenOf(pos);
+        if (index >= children.values.size()) {
+            throw std::out_of_range("LazyValue::at, index out of range");
+        }
+        return {*doc, children.values[index]};
+    }
+
+    StringView LazyValue::raw() const {
+        Scanner scanner(doc->text);
+        scanner.pos = pos;
+        scanner.skipValue();
+        return StringView(doc->text).substr(pos, scanner.pos - pos);
+    }
+
+    Json LazyValue::materialize() const {
+        Builder builder(std::pmr::get_default_resource(), false);
+        SaxReader reader(StringView(doc->text), nullptr, builder);
+        reader.pos = pos;
+        reader.readValue();
+        return std::move(builder.root);
+    }
+}
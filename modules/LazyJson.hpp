@@ -0,0 +1,89 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Json.hpp"
+
+namespace Json {
+    class LazyDocument;
+
+    // A value of a LazyDocument. Nothing below it is parsed until it is asked for: looking up a member or an
+    // element scans its container once, skipping over the children by matching brackets, and remembers where
+    // each child starts. The document has to outlive the value.
+    class LazyValue {
+    private:
+        LazyDocument *doc;
+        size_t pos;
+
+    public:
+        LazyValue(LazyDocument &doc, const size_t pos) : doc(&doc), pos(pos) {}
+
+        [[nodiscard]] DataType what() const;
+
+        // Scalars only, with the same alternatives as Json::get. Strings come back decoded as String.
+        template<class T>
+        [[nodiscard]] T get() const;
+
+        // Reads any of the numeric alternatives as a double.
+        [[nodiscard]] Number getNumber() const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] bool contains(StringView key) const;
+
+        // Throws std::out_of_range when there is no such member or element.
+        [[nodiscard]] LazyValue at(StringView key) const;
+
+        [[nodiscard]] LazyValue at(size_t index) const;
+
+        [[nodiscard]] LazyValue operator[](const StringView key) const {
+            return at(key);
+        }
+
+        [[nodiscard]] LazyValue operator[](const size_t index) const {
+            return at(index);
+        }
+
+        // The text of this value as it is in the input.
+        [[nodiscard]] StringView raw() const;
+
+        // Parses the whole subtree into a Json.
+        [[nodiscard]] Json materialize() const;
+    };
+
+    // Owns the text of a lazily parsed document. Only the parts that are read are ever parsed, malformed text
+    // in parts that are skipped goes unnoticed. Values keep pointing at their document, so it can neither be
+    // copied nor moved. Not safe to read from several threads at once.
+    class LazyDocument {
+    private:
+        friend class LazyValue;
+
+        struct Children {
+            // Decoded keys of an object, empty for arrays.
+            std::vector<StringView> keys;
+            std::vector<size_t> values;
+        };
+
+        std::string text;
+
+        // Containers that were scanned already, by the position of their opening bracket.
+        std::unordered_map<size_t, Children> scanned;
+
+        // Keys that had escapes, the views in Children point here.
+        std::deque<std::string> decodedKeys;
+
+        const Children &childrenOf(size_t pos);
+
+    public:
+        explicit LazyDocument(std::string text);
+
+        LazyDocument(const LazyDocument &other) = delete;
+
+        LazyDocument &operator=(const LazyDocument &other) = delete;
+
+        [[nodiscard]] LazyValue root();
+    };
+}
@@ -0,0 +1,107 @@
+#include <stdexcept>
+#include <utility>
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Json {
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string &fileName) {
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Could not open file " + fileName);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Could not read the size of file " + fileName);
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        // Empty files cannot be mapped, they are simply an empty view.
+        if (size != 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+        }
+        CloseHandle(file);
+
+        if (size != 0 && !data) {
+            if (mapping) CloseHandle(mapping);
+            throw std::runtime_error("Could not map file " + fileName);
+        }
+    }
+
+    void MappedFile::unmap() {
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        data = nullptr;
+        mapping = nullptr;
+        size = 0;
+    }
+#else
+    MappedFile::MappedFile(const std::string &fileName) {
+        const int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file " + fileName);
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Could not read the size of file " + fileName);
+        }
+        size = static_cast<size_t>(info.st_size);
+
+        // Empty files cannot be mapped, they are simply an empty view.
+        if (size != 0) {
+            void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Could not map file " + fileName);
+            }
+            // The parser reads front to back, so the kernel can read ahead aggressively and drop pages behind.
+            madvise(address, size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(address);
+        }
+        close(fd);
+    }
+
+    void MappedFile::unmap() {
+        if (data) munmap(const_cast<char *>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+#endif
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+#ifdef _WIN32
+            mapping = std::exchange(other.mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+}
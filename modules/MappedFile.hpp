@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include "JsonForwardHeader.hpp"
+
+namespace Json {
+    // Read-only view of a whole file through a memory mapping, pages are read in as the parser touches them.
+    // The parser bounds-checks every read and the stage-1 pass copies the last partial block, so the mapping
+    // covers exactly the file and needs no padding.
+    class MappedFile {
+    private:
+        const char *data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void *mapping = nullptr;
+#endif
+
+        void unmap();
+
+    public:
+        explicit MappedFile(const std::string &fileName);
+
+        MappedFile(const MappedFile &other) = delete;
+
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        ~MappedFile();
+
+        [[nodiscard]] StringView view() const {
+            return {data, size};
+        }
+    };
+}
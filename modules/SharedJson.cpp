@@ -0,0 +1,52 @@
+#include "Json.hpp"
+#include "JsonBuilder.hpp"
+#include "JsonSax.hpp"
+#include "JsonWriter.hpp"
+#include "SharedJson.hpp"
+
+namespace Json {
+    std::string SharedJson::deserialize(const Format format) const {
+        Writer writer(format);
+        writer.write(*this);
+        return std::move(writer.output());
+    }
+
+    SharedJson parseJsonShared(const StringView str) {
+        NodeBuilder<SharedJson, SharedObject, SharedArray> builder;
+        parseJsonSax(str, builder);
+        return std::move(builder.root);
+    }
+
+    SharedJson toShared(const Json &json) {
+        switch (json.what()) {
+            case DataType::STRING:
+                return SharedJson{json.getStringView()};
+            case DataType::OBJECT: {
+                SharedObject object;
+                object.reserve(json.get<Object>().size());
+                for (auto &&[K, V]: json.get<Object>()) {
+                    object.insert_or_assign(Key(K.view()), toShared(V));
+                }
+                return SharedJson{std::move(object)};
+            }
+            case DataType::ARRAY: {
+                SharedArray array;
+                array.reserve(json.get<Array>().size());
+                for (const Json &element: json.get<Array>()) {
+                    array.push_back(toShared(element));
+                }
+                return SharedJson{std::move(array)};
+            }
+            case DataType::NUMBER:
+                return SharedJson{json.get<Number>()};
+            case DataType::INTEGER:
+                return SharedJson{json.get<Integer>()};
+            case DataType::UNSIGNED:
+                return SharedJson{json.get<Unsigned>()};
+            case DataType::BOOL:
+                return SharedJson{json.get<Bool>()};
+            default:
+                return SharedJson{};
+        }
+    }
+}
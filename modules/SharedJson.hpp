@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "JsonForwardHeader.hpp"
+
+namespace Json {
+    class SharedJson;
+
+    using SharedArray = std::vector<SharedJson>;
+    using SharedObject = FlatMap<Key, SharedJson>;
+
+    // Json whose copies share their nodes through atomic reference counts, so copying a whole document
+    // costs one increment. Non-const access first clones the node if anyone else still shares it, cloning
+    // only this one level: children stay shared. Changing a nested value therefore copies just the nodes on
+    // the path to it. Copies may be read and changed from different threads, one SharedJson object may not.
+    class SharedJson {
+    private:
+        struct Node {
+            std::variant<String, SharedObject, SharedArray, Number, Bool, Integer, Unsigned> data;
+        };
+
+        // Null values have no node.
+        std::shared_ptr<Node> node;
+
+        // get<Object> and get<Array> name the Json alternatives, this type stores its own containers.
+        template<class T>
+        using Stored = std::conditional_t<std::is_same_v<T, Object>, SharedObject,
+                std::conditional_t<std::is_same_v<T, Array>, SharedArray, T>>;
+
+        // Makes node exclusively ours before it is changed.
+        void detach() {
+            if (node.use_count() > 1) {
+                node = std::make_shared<Node>(*node);
+            } else {
+                // use_count is a relaxed load. When it saw another thread drop its copy, the fence makes that
+                // thread's reads of the node happen before the changes made here.
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+        }
+
+    public:
+        SharedJson() = default;
+
+        explicit SharedJson(StringView text) : node(std::make_shared<Node>(Node{String(text)})) {}
+
+        explicit SharedJson(const char *text) : SharedJson(StringView(text)) {}
+
+        explicit SharedJson(SharedObject &&object) : node(std::make_shared<Node>(Node{std::move(object)})) {}
+
+        explicit SharedJson(SharedArray &&array) : node(std::make_shared<Node>(Node{std::move(array)})) {}
+
+        explicit SharedJson(const Number number) : node(std::make_shared<Node>(Node{number})) {}
+
+        explicit SharedJson(const Integer number) : node(std::make_shared<Node>(Node{number})) {}
+
+        explicit SharedJson(const Unsigned number) : node(std::make_shared<Node>(Node{number})) {}
+
+        explicit SharedJson(const Bool value) : node(std::make_shared<Node>(Node{value})) {}
+
+        SharedJson(const SharedJson &other) = default;
+
+        SharedJson(SharedJson &&other) noexcept = default;
+
+        SharedJson &operator=(const SharedJson &other) = default;
+
+        SharedJson &operator=(SharedJson &&other) noexcept = default;
+
+        // Whether both hold the very same node, that is nothing was copied between them.
+        [[nodiscard]] bool sharesNodeWith(const SharedJson &other) const {
+            return node == other.node;
+        }
+
+        [[nodiscard]] DataType what() const {
+            if (!node) return DataType::NULLPTR;
+            switch (node->data.index()) {
+                case 0:
+                    return DataType::STRING;
+                case 1:
+                    return DataType::OBJECT;
+                case 2:
+                    return DataType::ARRAY;
+                case 3:
+                    return DataType::NUMBER;
+                case 4:
+                    return DataType::BOOL;
+                case 5:
+                    return DataType::INTEGER;
+                default:
+                    return DataType::UNSIGNED;
+            }
+        }
+
+        // Same alternatives as Json::get, Object and Array come back as SharedObject and SharedArray.
+        // Non-const access unshares this node first, get<NullPtr> returns by value.
+        template<class T>
+        decltype(auto) get(this auto &&self) {
+            if constexpr (std::is_same_v<T, NullPtr>) {
+                if (self.node) throw std::bad_variant_access();
+                return nullptr;
+            } else {
+                if (!self.node) throw std::bad_variant_access();
+                if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)>>) {
+                    return std::get<Stored<T>>(std::as_const(self.node->data));
+                } else {
+                    self.detach();
+                    return std::get<Stored<T>>(self.node->data);
+                }
+            }
+        }
+
+        decltype(auto) visit(this auto &&self, auto &&visitor) {
+            if (!self.node) return visitor(nullptr);
+            if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)>>) {
+                return std::visit(visitor, std::as_const(self.node->data));
+            } else {
+                self.detach();
+                return std::visit(visitor, self.node->data);
+            }
+        }
+
+        [[nodiscard]] StringView getStringView() const {
+            return get<String>();
+        }
+
+        // Reads any of the numeric alternatives as a double.
+        [[nodiscard]] Number getNumber() const {
+            switch (what()) {
+                case DataType::INTEGER:
+                    return static_cast<Number>(get<Integer>());
+                case DataType::UNSIGNED:
+                    return static_cast<Number>(get<Unsigned>());
+                default:
+                    return get<Number>();
+            }
+        }
+
+        [[nodiscard]] std::string deserialize(Format format = Format::PRETTY) const;
+    };
+
+    SharedJson parseJsonShared(StringView str);
+
+    SharedJson toShared(const Json &json);
+}
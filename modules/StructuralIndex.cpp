@@ -0,0 +1,235 @@
+#include <bit>
+#include <cstring>
+#include "ByteSearch.hpp"
+#include "StructuralIndex.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JSON_STRUCTURAL_INDEX_X86
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define JSON_TARGET_AVX2
+#else
+#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Json {
+    namespace {
+        constexpr size_t blockSize = 64;
+
+        // Raw classification of one 64 byte block, bit i describes byte i.
+        struct BlockMasks {
+            uint64_t quote;
+            uint64_t backslash;
+            uint64_t whitespace;
+            uint64_t bracket;
+            uint64_t separator;
+        };
+
+        using Classifier = BlockMasks (*)(const uint8_t *);
+
+        [[maybe_unused]] BlockMasks classifyScalar(const uint8_t *block) {
+            BlockMasks masks{};
+            for (size_t i = 0; i < blockSize; i++) {
+                const uint64_t bit = uint64_t{1} << i;
+                switch (block[i]) {
+                    case '"':
+                        masks.quote |= bit;
+                        break;
+                    case '\\':
+                        masks.backslash |= bit;
+                        break;
+                    case ' ':
+                    case '\t':
+                    case '\n':
+                    case '\r':
+                        masks.whitespace |= bit;
+                        break;
+                    case '{':
+                    case '}':
+                    case '[':
+                    case ']':
+                        masks.bracket |= bit;
+                        break;
+                    case ':':
+                    case ',':
+                        masks.separator |= bit;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return masks;
+        }
+
+#ifdef JSON_STRUCTURAL_INDEX_X86
+        // SSE2 is part of x86-64, so this kernel needs no runtime check.
+        BlockMasks classifySse2(const uint8_t *block) {
+            BlockMasks masks{};
+            for (size_t i = 0; i < blockSize; i += 16) {
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+                const __m128i folded = _mm_or_si128(b, _mm_set1_epi8(bracketFold));
+
+                const auto bits = [i](const __m128i predicate) {
+                    return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(predicate))) << i;
+                };
+                masks.quote |= bits(bytesEqual(b, '"'));
+                masks.backslash |= bits(bytesEqual(b, '\\'));
+                masks.whitespace |= bits(_mm_or_si128(_mm_or_si128(bytesEqual(b, ' '), bytesEqual(b, '\t')),
+                                                      _mm_or_si128(bytesEqual(b, '\n'), bytesEqual(b, '\r'))));
+                masks.bracket |= bits(_mm_or_si128(bytesEqual(folded, '{'), bytesEqual(folded, '}')));
+                masks.separator |= bits(_mm_or_si128(bytesEqual(b, ':'), bytesEqual(b, ',')));
+            }
+            return masks;
+        }
+
+        JSON_TARGET_AVX2 __m256i avx2Eq(const __m256i bytes, const char c) {
+            return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+        }
+
+        JSON_TARGET_AVX2 uint32_t avx2Bits(const __m256i predicate) {
+            return static_cast<uint32_t>(_mm256_movemask_epi8(predicate));
+        }
+
+        JSON_TARGET_AVX2 BlockMasks classifyAvx2(const uint8_t *block) {
+            BlockMasks masks{};
+            for (size_t i = 0; i < blockSize; i += 32) {
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+                const __m256i folded = _mm256_or_si256(b, _mm256_set1_epi8(bracketFold));
+
+                masks.quote |= uint64_t{avx2Bits(avx2Eq(b, '"'))} << i;
+                masks.backslash |= uint64_t{avx2Bits(avx2Eq(b, '\\'))} << i;
+                masks.whitespace |= uint64_t{avx2Bits(
+                        _mm256_or_si256(_mm256_or_si256(avx2Eq(b, ' '), avx2Eq(b, '\t')),
+                                        _mm256_or_si256(avx2Eq(b, '\n'), avx2Eq(b, '\r'))))} << i;
+                masks.bracket |= uint64_t{avx2Bits(_mm256_or_si256(avx2Eq(folded, '{'), avx2Eq(folded, '}')))} << i;
+                masks.separator |= uint64_t{avx2Bits(_mm256_or_si256(avx2Eq(b, ':'), avx2Eq(b, ',')))} << i;
+            }
+            return masks;
+        }
+
+        bool cpuHasAvx2() {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return false;
+            __cpuid(info, 1);
+            constexpr int osxsave = 1 << 27, avx = 1 << 28;
+            if ((info[2] & (osxsave | avx)) != (osxsave | avx)) return false;
+            // The OS has to save the upper halves of the ymm registers.
+            if ((_xgetbv(0) & 0x6) != 0x6) return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+
+        struct Kernel {
+            Classifier classify;
+            const char *name;
+        };
+
+        const Kernel &selectKernel() {
+            static const Kernel kernel = [] {
+#ifdef JSON_STRUCTURAL_INDEX_X86
+                if (cpuHasAvx2()) return Kernel{classifyAvx2, "avx2"};
+                return Kernel{classifySse2, "sse2"};
+#else
+                return Kernel{classifyScalar, "scalar"};
+#endif
+            }();
+            return kernel;
+        }
+
+        // Bit i of the result is the parity of the set bits at positions 0..i.
+        uint64_t prefixXor(uint64_t bits) {
+            bits ^= bits << 1;
+            bits ^= bits << 2;
+            bits ^= bits << 4;
+            bits ^= bits << 8;
+            bits ^= bits << 16;
+            bits ^= bits << 32;
+            return bits;
+        }
+
+        // The state carried from one block to the next.
+        struct Scanner {
+            uint64_t prevEndsOddBackslash = 0;
+            uint64_t prevInString = 0;
+            uint64_t prevScalar = 0;
+
+            // Bytes preceded by an odd-length run of backslashes.
+            uint64_t escaped(const uint64_t backslash) {
+                constexpr uint64_t evenBits = 0x5555555555555555ULL;
+                constexpr uint64_t oddBits = ~evenBits;
+
+                const uint64_t startEdges = backslash & ~(backslash << 1);
+                const uint64_t evenStartMask = evenBits ^ prevEndsOddBackslash;
+                const uint64_t evenStarts = startEdges & evenStartMask;
+                const uint64_t oddStarts = startEdges & ~evenStartMask;
+                const uint64_t evenCarries = backslash + evenStarts;
+
+                uint64_t oddCarries = backslash + oddStarts;
+                const bool endsOddBackslash = oddCarries < backslash;
+                oddCarries |= prevEndsOddBackslash;
+                prevEndsOddBackslash = endsOddBackslash ? 1 : 0;
+
+                const uint64_t evenCarryEnds = evenCarries & ~backslash;
+                const uint64_t oddCarryEnds = oddCarries & ~backslash;
+                return (evenCarryEnds & oddBits) | (oddCarryEnds & evenBits);
+            }
+
+            uint64_t tokenStarts(const BlockMasks &masks) {
+                const uint64_t quote = masks.quote & ~escaped(masks.backslash);
+
+                // Set from an opening quote up to, but not including, its closing quote.
+                const uint64_t inString = prefixXor(quote) ^ prevInString;
+                prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+                const uint64_t scalar = ~(masks.whitespace | masks.bracket | masks.separator | quote | inString);
+                const uint64_t scalarStarts = scalar & ~(scalar << 1 | prevScalar);
+                prevScalar = scalar >> 63;
+
+                // Commas and colons end a scalar but never start a token, so they are left out.
+                return (masks.bracket & ~inString) | (quote & inString) | scalarStarts;
+            }
+        };
+    }
+
+    StructuralIndex::StructuralIndex(const std::string_view sv) {
+        const Classifier classify = selectKernel().classify;
+        const auto *data = reinterpret_cast<const uint8_t *>(sv.data());
+
+        // Roughly one token every eight bytes in typical documents.
+        tokens.reserve(sv.size() / 8 + 1);
+
+        Scanner scanner;
+        const auto flatten = [&](uint64_t bits, const size_t base) {
+            while (bits) {
+                tokens.push_back(static_cast<Position>(base + std::countr_zero(bits)));
+                bits &= bits - 1;
+            }
+        };
+
+        size_t base = 0;
+        for (; base + blockSize <= sv.size(); base += blockSize) {
+            flatten(scanner.tokenStarts(classify(data + base)), base);
+        }
+
+        if (base < sv.size()) {
+            uint8_t tail[blockSize];
+            std::memset(tail, ' ', blockSize);
+            std::memcpy(tail, data + base, sv.size() - base);
+            flatten(scanner.tokenStarts(classify(tail)), base);
+        }
+    }
+
+    const char *StructuralIndex::kernelName() {
+        return selectKernel().name;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Json {
+    // Stage-1 pass over a Json text. Records the position of every token start outside of strings:
+    // opening quotes, braces, brackets and the first byte of every bare scalar (numbers, true, false, null).
+    // Commas, colons and whitespace are not recorded, the Builder skips over them anyway.
+    class StructuralIndex {
+    public:
+        using Position = uint32_t;
+
+        // Positions are stored as 32 bit offsets, longer inputs have to be parsed without an index.
+        constexpr static size_t maxInputSize = UINT32_MAX;
+
+        explicit StructuralIndex(std::string_view sv);
+
+        [[nodiscard]] const std::vector<Position> &positions() const {
+            return tokens;
+        }
+
+        // Name of the block classifier picked for this machine, "avx2", "sse2" or "scalar".
+        [[nodiscard]] static const char *kernelName();
+
+    private:
+        std::vector<Position> tokens;
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Json {
+    // Fixed set of worker threads taking tasks from one queue. Destruction finishes the queued tasks first.
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        bool stopping = false;
+
+        void work();
+
+    public:
+        // 0 threads means one per hardware thread.
+        explicit ThreadPool(size_t threads = 0);
+
+        ThreadPool(const ThreadPool &other) = delete;
+
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+
+        ~ThreadPool();
+
+        [[nodiscard]] size_t size() const {
+            return workers.size();
+        }
+
+        // The future rethrows whatever the task threw.
+        template<class Task>
+        std::future<std::invoke_result_t<Task>> submit(Task &&task) {
+            // std::function needs a copyable target, the packaged_task is shared instead.
+            auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<Task>()>>(std::forward<Task>(task));
+            auto future = packaged->get_future();
+            {
+                std::lock_guard lock(mutex);
+                tasks.emplace_back([packaged] { (*packaged)(); });
+            }
+            wakeUp.notify_one();
+            return future;
+        }
+    };
+}